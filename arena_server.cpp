@@ -0,0 +1,230 @@
+#include "arena_server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "byte_io.h"
+
+
+namespace {
+
+// Enough for any client packet; larger datagrams are not ours and get truncated
+const size_t RECEIVE_BUFFER_SIZE = 512;
+
+// Kernel socket buffers: a tick's worth of inputs from every client has to queue up between
+// two drains, far beyond the OS default of a few hundred datagrams
+const int SOCKET_BUFFER_BYTES = 4 << 20;
+
+}
+
+
+ArenaServer::ArenaServer(const ArenaServerConfig& config)
+    : m_config(config),
+      m_arena(config.width, config.height, config.slots, config.food, config.seed),
+      m_clientCount(0),
+      m_directions(config.slots, Direction::NONE),
+      m_botRng(config.seed, RngStream::POLICY),
+      m_tick(0),
+      m_receiveBuffer(RECEIVE_BUFFER_SIZE) {
+    m_config.viewRadius = std::min(std::max(config.viewRadius, 0), NET_MAX_VIEW_RADIUS);
+    m_arena.setTickMicros(config.tickMicros);
+    m_clients.resize(config.slots);
+    for (Client& client : m_clients) client.encoder = SnapshotEncoder(m_config.viewRadius);
+    const size_t side = static_cast<size_t>(2 * m_config.viewRadius + 1);
+    m_view.resize(side * side);
+    m_packet.reserve(NET_MAX_PACKET_SIZE);
+}
+
+bool ArenaServer::open() {
+    if (!m_socket.open(m_config.port, m_config.loopbackOnly)) return false;
+    m_socket.setBufferSizes(SOCKET_BUFFER_BYTES); // Best effort; the OS may cap it
+    return true;
+}
+
+void ArenaServer::tick() {
+    const auto start = std::chrono::steady_clock::now();
+    receivePackets();
+
+    for (size_t slot = 0; slot < m_clients.size(); ++slot) {
+        Client& client = m_clients[slot];
+        if (client.connected && m_tick - client.lastHeardTick > m_config.clientTimeoutTicks) disconnectClient(slot);
+        if (client.connected) m_directions[slot] = client.direction;
+        else m_directions[slot] = m_config.bots ? m_arena.pickBotDirection(slot, m_botRng) : Direction::NONE;
+    }
+    m_arena.step(m_directions.data());
+    ++m_tick;
+    sendSnapshots();
+
+    m_stats.ticks++;
+    m_stats.clientTicks += m_clientCount;
+    m_stats.tickMicros.push_back(static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()));
+}
+
+ArenaServerStats ArenaServer::takeStats() {
+    ArenaServerStats stats;
+    std::swap(stats, m_stats);
+    m_stats.tickMicros.reserve(stats.tickMicros.capacity());
+    return stats;
+}
+
+void ArenaServer::receivePackets() {
+    UdpAddress from;
+    for (;;) {
+        const int size = m_socket.receive(m_receiveBuffer.data(), m_receiveBuffer.size(), from);
+        if (size <= 0) break;
+        m_stats.packetsIn++;
+        m_stats.bytesIn += static_cast<uint64_t>(size);
+        handlePacket(m_receiveBuffer.data(), static_cast<size_t>(size), from);
+    }
+}
+
+void ArenaServer::handlePacket(const uint8_t* data, size_t size, const UdpAddress& from) {
+    NetMessage message;
+    if (!readNetHeader(data, size, message)) return;
+    ByteReader reader(data + 3, size - 3);
+
+    const auto known = m_slotByAddress.find(from.getKey());
+    if (message == NetMessage::CONNECT) {
+        uint8_t version;
+        if (!reader.getU8(version)) return;
+        if (version != NET_PROTOCOL_VERSION) {
+            m_packet.clear();
+            writeNetHeader(m_packet, NetMessage::REJECT);
+            m_packet.push_back(static_cast<uint8_t>(NetRejectReason::VERSION));
+            sendTo(from);
+        } else if (known != m_slotByAddress.end()) {
+            m_clients[known->second].lastHeardTick = m_tick;
+            connectClient(from); // The WELCOME got lost; send it again
+        } else {
+            connectClient(from);
+        }
+        return;
+    }
+    if (known == m_slotByAddress.end()) return;
+
+    Client& client = m_clients[known->second];
+    client.lastHeardTick = m_tick;
+    if (message == NetMessage::INPUT) {
+        uint32_t ackedTick;
+        uint8_t direction;
+        if (!reader.getU32(ackedTick) || !reader.getU8(direction)) return;
+        // Packets may arrive out of order; never fall back to an older baseline
+        if (ackedTick != NET_NO_TICK && ackedTick <= m_tick &&
+            (client.ackedTick == NET_NO_TICK || ackedTick > client.ackedTick)) {
+            client.ackedTick = ackedTick;
+        }
+        if (direction <= static_cast<uint8_t>(Direction::RIGHT)) client.direction = static_cast<Direction>(direction);
+    } else if (message == NetMessage::DISCONNECT) {
+        disconnectClient(known->second);
+    }
+}
+
+void ArenaServer::connectClient(const UdpAddress& from) {
+    size_t slot;
+    const auto known = m_slotByAddress.find(from.getKey());
+    if (known != m_slotByAddress.end()) {
+        slot = known->second;
+    } else {
+        slot = 0;
+        while (slot < m_clients.size() && m_clients[slot].connected) ++slot;
+        if (slot == m_clients.size()) {
+            m_packet.clear();
+            writeNetHeader(m_packet, NetMessage::REJECT);
+            m_packet.push_back(static_cast<uint8_t>(NetRejectReason::FULL));
+            sendTo(from);
+            return;
+        }
+        Client& client = m_clients[slot];
+        client.connected = true;
+        client.address = from;
+        client.direction = Direction::NONE;
+        client.ackedTick = NET_NO_TICK;
+        client.lastHeardTick = m_tick;
+        client.encoder.reset();
+        m_slotByAddress[from.getKey()] = slot;
+        m_clientCount++;
+    }
+
+    m_packet.clear();
+    writeNetHeader(m_packet, NetMessage::WELCOME);
+    ByteWriter writer(m_packet);
+    writer.putU32(static_cast<uint32_t>(slot));
+    writer.putU16(static_cast<uint16_t>(m_arena.getWidth()));
+    writer.putU16(static_cast<uint16_t>(m_arena.getHeight()));
+    writer.putU8(static_cast<uint8_t>(m_config.viewRadius));
+    writer.putU32(static_cast<uint32_t>(m_arena.getTickMicros()));
+    sendTo(from);
+}
+
+void ArenaServer::disconnectClient(size_t slot) {
+    Client& client = m_clients[slot];
+    m_slotByAddress.erase(client.address.getKey());
+    client.connected = false;
+    m_clientCount--;
+}
+
+void ArenaServer::sendSnapshots() {
+    const int radius = m_config.viewRadius;
+    for (size_t slot = 0; slot < m_clients.size(); ++slot) {
+        Client& client = m_clients[slot];
+        if (!client.connected) continue;
+        // A dead snake keeps its last head, so the view stays put until the respawn
+        const ArenaSnake& snake = m_arena.getSnake(slot);
+        SnapshotHeader header;
+        header.tick = m_tick;
+        header.originX = static_cast<int32_t>(snake.head % static_cast<uint32_t>(m_arena.getWidth())) - radius;
+        header.originY = static_cast<int32_t>(snake.head / static_cast<uint32_t>(m_arena.getWidth())) - radius;
+        header.score = snake.score;
+        header.alive = m_arena.isAlive(slot);
+        buildView(slot, header.originX, header.originY);
+
+        m_packet.clear();
+        if (client.encoder.encode(header, m_view.data(), client.ackedTick, m_packet)) m_stats.keyframes++;
+        sendTo(client.address);
+    }
+}
+
+void ArenaServer::buildView(size_t slot, int32_t originX, int32_t originY) {
+    const int side = 2 * m_config.viewRadius + 1;
+    const int width = m_arena.getWidth();
+    // Open part of the board: inside the spike walls (which never leave the board). Bodies under
+    // advanced spikes still kill, so they show as blocked as well
+    const int left = std::max(m_arena.getLeftSpikeWall(), originX);
+    const int right = std::min(m_arena.getRightSpikeWall(), originX + side);
+    const int top = m_arena.getTopSpikeWall();
+    const int bottom = m_arena.getBottomSpikeWall();
+    const uint32_t self = static_cast<uint32_t>(slot + 1);
+
+    for (int vy = 0; vy < side; ++vy) {
+        uint8_t* row = &m_view[static_cast<size_t>(vy) * side];
+        const int y = originY + vy;
+        if (y < top || y >= bottom || left >= right) {
+            std::memset(row, static_cast<int>(ViewCell::BLOCKED), static_cast<size_t>(side));
+            continue;
+        }
+        std::memset(row, static_cast<int>(ViewCell::BLOCKED), static_cast<size_t>(left - originX));
+        std::memset(row + (right - originX), static_cast<int>(ViewCell::BLOCKED), static_cast<size_t>(originX + side - right));
+        const uint32_t rowStart = static_cast<uint32_t>(y * width);
+        for (int x = left; x < right; ++x) {
+            const uint32_t cell = rowStart + static_cast<uint32_t>(x);
+            const uint32_t owner = m_arena.getOwner(cell);
+            ViewCell code;
+            if (owner == 0) {
+                code = m_arena.isFood(cell) ? ViewCell::FOOD : ViewCell::EMPTY;
+            } else {
+                const bool head = m_arena.getSnake(owner - 1).head == cell;
+                if (owner == self) code = head ? ViewCell::OWN_HEAD : ViewCell::OWN_BODY;
+                else code = head ? ViewCell::OTHER_HEAD : ViewCell::OTHER_BODY;
+            }
+            row[x - originX] = static_cast<uint8_t>(code);
+        }
+    }
+}
+
+void ArenaServer::sendTo(const UdpAddress& to) {
+    if (!m_socket.send(m_packet.data(), m_packet.size(), to)) return;
+    m_stats.packetsOut++;
+    m_stats.bytesOut += m_packet.size();
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "arena_sim.h"
+#include "net_protocol.h"
+#include "rng.h"
+#include "udp_socket.h"
+
+
+struct ArenaServerConfig {
+    uint16_t port = 7777;
+    bool loopbackOnly = true;
+    int width = 200;
+    int height = 120;
+    size_t slots = 256;          // Arena snakes; each client takes one over
+    size_t food = 128;
+    int viewRadius = NET_MAX_VIEW_RADIUS;
+    bool bots = true;            // Slots without a client play the arena bot, else they wait
+    uint32_t seed = 0;
+    int32_t tickMicros = ARENA_TICK_MICROS; // The rate the caller runs tick() at, sent to clients
+    uint32_t clientTimeoutTicks = 50; // Ticks without a packet before a client is dropped
+};
+
+// Totals since the last takeStats().
+struct ArenaServerStats {
+    uint64_t ticks = 0;
+    uint64_t packetsIn = 0;
+    uint64_t bytesIn = 0;
+    uint64_t packetsOut = 0;
+    uint64_t bytesOut = 0;
+    uint64_t keyframes = 0;     // Snapshots sent without a baseline
+    uint64_t clientTicks = 0;   // Sum over ticks of the connected clients, for per-client rates
+    std::vector<uint32_t> tickMicros; // Work time of every tick: receive, step, snapshots
+};
+
+
+// Authoritative arena server over UDP. tick() drains the socket, steps the ArenaSim with the
+// latest input of every client (bots drive the other slots) and sends each client a
+// delta-coded snapshot of the view around its head. Work per tick is O(packets + snakes +
+// clients * view cells) and needs no thread of its own; the caller paces the ticks.
+class ArenaServer {
+public:
+    explicit ArenaServer(const ArenaServerConfig& config);
+
+    bool open(); // Binds the socket; false when the port is taken
+    void tick();
+
+    size_t getClientCount() const { return m_clientCount; }
+    uint16_t getPort() const { return m_socket.getPort(); }
+    const ArenaSim& getArena() const { return m_arena; }
+
+    ArenaServerStats takeStats();
+
+private:
+    struct Client {
+        bool connected = false;
+        UdpAddress address{0, 0};
+        Direction direction = Direction::NONE;
+        uint32_t ackedTick = NET_NO_TICK;
+        uint32_t lastHeardTick = 0;
+        SnapshotEncoder encoder;
+    };
+
+    void receivePackets();
+    void handlePacket(const uint8_t* data, size_t size, const UdpAddress& from);
+    void connectClient(const UdpAddress& from);
+    void disconnectClient(size_t slot);
+    void sendSnapshots();
+    void buildView(size_t slot, int32_t originX, int32_t originY);
+    void sendTo(const UdpAddress& to);
+
+    ArenaServerConfig m_config;
+    ArenaSim m_arena;
+    UdpSocket m_socket;
+    std::vector<Client> m_clients; // Indexed by arena slot
+    std::unordered_map<uint64_t, size_t> m_slotByAddress; // UdpAddress::getKey() -> slot
+    size_t m_clientCount;
+    std::vector<Direction> m_directions;
+    Rng m_botRng;
+    uint32_t m_tick;
+
+    std::vector<uint8_t> m_packet;
+    std::vector<uint8_t> m_receiveBuffer;
+    std::vector<uint8_t> m_view;
+    ArenaServerStats m_stats;
+};
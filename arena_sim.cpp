@@ -0,0 +1,269 @@
+#include "arena_sim.h"
+
+#include <algorithm>
+
+
+namespace {
+
+// Neighbour offsets in Direction order (UP, DOWN, LEFT, RIGHT)
+const int DIRECTION_DX[4] = {0, 0, -1, 1};
+const int DIRECTION_DY[4] = {-1, 1, 0, 0};
+
+// Random cells tried before giving up on placing food or a snake this step
+const int MAX_PLACEMENT_TRIES = 16;
+
+}
+
+
+ArenaSim::ArenaSim(int width, int height, size_t snakeCount, size_t foodCount, uint32_t seed)
+    : m_width(width),
+      m_height(height),
+      m_snakes(snakeCount),
+      m_owner(static_cast<size_t>(width) * height, 0),
+      m_next(static_cast<size_t>(width) * height, 0),
+      m_freeCells(static_cast<size_t>(width) * height),
+      m_food(width, height),
+      m_foodCount(0),
+      m_foodTarget(foodCount),
+      m_aliveCount(0),
+      m_fate(snakeCount, Fate::WAIT),
+      m_target(snakeCount, 0),
+      m_claimStamp(static_cast<size_t>(width) * height, 0),
+      m_claimSnake(static_cast<size_t>(width) * height, 0),
+      m_stamp(0),
+      m_tickMicros(ARENA_TICK_MICROS) {
+    m_changed.reserve(4 * snakeCount + foodCount);
+    reset(seed);
+}
+
+void ArenaSim::reset(uint32_t seed) {
+    m_rng.seed(seed, RngStream::FOOD);
+    std::fill(m_owner.begin(), m_owner.end(), 0);
+    m_freeCells.clear();
+    m_food.clear();
+    m_foodCount = 0;
+    m_aliveCount = 0;
+    m_changed.clear();
+    resetSpikeWalls();
+    m_tick = 0;
+    m_deathCount = 0;
+    m_headOnCount = 0;
+
+    for (size_t i = 0; i < m_snakes.size(); ++i) {
+        m_snakes[i] = ArenaSnake{0, 0, 0, Direction::NONE, 0};
+        spawnSnake(i);
+    }
+    uint32_t cell;
+    while (m_foodCount < m_foodTarget && sampleEmptyCell(cell)) {
+        m_food.setCell(cell);
+        m_foodCount++;
+    }
+}
+
+bool ArenaSim::isOpen(int x, int y) const {
+    return isInsideWalls(x, y) && m_owner[static_cast<size_t>(y) * m_width + x] == 0;
+}
+
+void ArenaSim::occupy(uint32_t cell, size_t snake) {
+    m_owner[cell] = static_cast<uint32_t>(snake + 1);
+    m_freeCells.occupy(cell);
+    m_changed.push_back(cell);
+}
+
+void ArenaSim::release(uint32_t cell) {
+    m_owner[cell] = 0;
+    m_freeCells.release(cell);
+    m_changed.push_back(cell);
+}
+
+bool ArenaSim::sampleEmptyCell(uint32_t& cell) {
+    if (m_freeCells.getFreeCount() == 0) return false;
+    for (int attempt = 0; attempt < MAX_PLACEMENT_TRIES; ++attempt) {
+        cell = m_freeCells.sample(m_rng);
+        if (!m_food.testCell(cell) && isInsideWalls(static_cast<int>(cell % m_width), static_cast<int>(cell / m_width))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ArenaSim::spawnSnake(size_t i) {
+    uint32_t cell;
+    if (!sampleEmptyCell(cell)) return; // Crowded, try again next step
+    occupy(cell, i);
+    m_snakes[i] = ArenaSnake{cell, cell, 1, Direction::NONE, 0};
+    m_aliveCount++;
+}
+
+void ArenaSim::killSnake(size_t i) {
+    ArenaSnake& snake = m_snakes[i];
+    for (uint32_t cell = snake.tail, left = snake.length; left > 0; cell = m_next[cell], --left) release(cell);
+    snake.length = 0;
+    m_aliveCount--;
+    m_deathCount++;
+}
+
+void ArenaSim::resetSpikeWalls() {
+    m_foodTimer = 0;
+    m_spikeAdvanceTimer = 0;
+    m_leftSpikeWall = 0;
+    m_rightSpikeWall = m_width;
+    m_topSpikeWall = 0;
+    m_bottomSpikeWall = m_height;
+}
+
+void ArenaSim::advanceSpikeWalls() {
+    if (m_foodTimer < SPIKE_TIMER_MICROS) m_foodTimer += m_tickMicros;
+    if (m_foodTimer < SPIKE_TIMER_MICROS) return;
+
+    m_spikeAdvanceTimer += m_tickMicros;
+    if (m_spikeAdvanceTimer >= SPIKE_ADVANCE_INTERVAL_MICROS) {
+        m_spikeAdvanceTimer -= SPIKE_ADVANCE_INTERVAL_MICROS;
+        const int left = m_leftSpikeWall, right = m_rightSpikeWall, top = m_topSpikeWall, bottom = m_bottomSpikeWall;
+        if (m_leftSpikeWall < m_rightSpikeWall - 1) m_leftSpikeWall++;
+        if (m_rightSpikeWall > m_leftSpikeWall + 1) m_rightSpikeWall--;
+        if (m_topSpikeWall < m_bottomSpikeWall - 1) m_topSpikeWall++;
+        if (m_bottomSpikeWall > m_topSpikeWall + 1) m_bottomSpikeWall--;
+        dropCoveredFood(left, right, top, bottom);
+    }
+}
+
+void ArenaSim::dropCoveredFood(int left, int right, int top, int bottom) {
+    for (int y = top; y < bottom; ++y) {
+        const bool rowCovered = y < m_topSpikeWall || y >= m_bottomSpikeWall;
+        for (int x = left; x < right; ++x) {
+            if (!rowCovered && x == m_leftSpikeWall) x = m_rightSpikeWall; // Skip the cells still inside
+            if (x >= right) break;
+            const uint32_t cell = static_cast<uint32_t>(y * m_width + x);
+            if (!m_food.testCell(cell)) continue;
+            m_food.resetCell(cell);
+            m_foodCount--;
+            m_changed.push_back(cell);
+        }
+    }
+}
+
+void ArenaSim::step(const Direction* directions) {
+    m_changed.clear();
+    m_tick++;
+    if (++m_stamp == 0) { // Stamp wrapped, forget every claim
+        std::fill(m_claimStamp.begin(), m_claimStamp.end(), 0);
+        m_stamp = 1;
+    }
+    advanceSpikeWalls();
+
+    for (size_t i = 0; i < m_snakes.size(); ++i) {
+        if (m_snakes[i].length == 0) spawnSnake(i);
+    }
+
+    // Decide every move against the board before the step: walls, bodies (tails included) and
+    // the cells other heads already claimed this tick
+    for (size_t i = 0; i < m_snakes.size(); ++i) {
+        ArenaSnake& snake = m_snakes[i];
+        m_fate[i] = Fate::WAIT;
+        if (snake.length == 0) continue;
+        const Direction requested = directions[i];
+        if (requested != Direction::NONE && !isOppositeDirection(requested, snake.direction)) {
+            snake.direction = requested;
+        }
+        if (snake.direction == Direction::NONE) continue;
+
+        const int d = static_cast<int>(snake.direction);
+        const int x = static_cast<int>(snake.head % m_width) + DIRECTION_DX[d];
+        const int y = static_cast<int>(snake.head / m_width) + DIRECTION_DY[d];
+        if (x < 0 || x >= m_width || y < 0 || y >= m_height || !isOpen(x, y)) {
+            m_fate[i] = Fate::DIE;
+            continue;
+        }
+        const uint32_t target = static_cast<uint32_t>(y * m_width + x);
+        if (m_claimStamp[target] == m_stamp) { // Head-to-head: both lose
+            const uint32_t other = m_claimSnake[target];
+            if (m_fate[other] == Fate::MOVE) m_headOnCount++;
+            m_fate[other] = Fate::DIE;
+            m_fate[i] = Fate::DIE;
+            m_headOnCount++;
+            continue;
+        }
+        m_claimStamp[target] = m_stamp;
+        m_claimSnake[target] = static_cast<uint32_t>(i);
+        m_target[i] = target;
+        m_fate[i] = Fate::MOVE;
+    }
+
+    // Targets were free before the step and claimed once, so moves cannot interfere
+    size_t eaten = 0;
+    for (size_t i = 0; i < m_snakes.size(); ++i) {
+        if (m_fate[i] != Fate::MOVE) continue;
+        ArenaSnake& snake = m_snakes[i];
+        const uint32_t target = m_target[i];
+        m_next[snake.head] = target;
+        snake.head = target;
+        occupy(target, i);
+        if (m_food.testCell(target)) {
+            m_food.resetCell(target);
+            m_foodCount--;
+            eaten++;
+            snake.length++;
+            snake.score++;
+        } else {
+            const uint32_t tail = snake.tail;
+            snake.tail = m_next[tail];
+            release(tail);
+        }
+    }
+    for (size_t i = 0; i < m_snakes.size(); ++i) {
+        if (m_fate[i] == Fate::DIE) killSnake(i);
+    }
+
+    // Walls closed in on a board with nobody left to eat would stay closed, and respawning
+    // snakes would have nowhere to go
+    if (eaten > 0 || m_aliveCount == 0) resetSpikeWalls();
+    uint32_t cell;
+    while (m_foodCount < m_foodTarget && sampleEmptyCell(cell)) {
+        m_food.setCell(cell);
+        m_foodCount++;
+        m_changed.push_back(cell);
+    }
+}
+
+bool ArenaSim::isNearOtherHead(int x, int y, size_t i) const {
+    for (int d = 0; d < 4; ++d) {
+        const int nx = x + DIRECTION_DX[d];
+        const int ny = y + DIRECTION_DY[d];
+        if (nx < 0 || nx >= m_width || ny < 0 || ny >= m_height) continue;
+        const uint32_t cell = static_cast<uint32_t>(ny * m_width + nx);
+        const uint32_t owner = m_owner[cell];
+        if (owner != 0 && owner != i + 1 && m_snakes[owner - 1].head == cell) return true;
+    }
+    return false;
+}
+
+Direction ArenaSim::pickBotDirection(size_t i, Rng& rng) const {
+    const ArenaSnake& snake = m_snakes[i];
+    if (snake.length == 0) return Direction::NONE;
+    const int x = static_cast<int>(snake.head % m_width);
+    const int y = static_cast<int>(snake.head / m_width);
+
+    // Score each direction: blocked 0, next to another head (it may move there too) 1, open 2,
+    // food 4; going straight wins ties most of the time
+    const uint32_t roll = rng.next();
+    const int first = static_cast<int>(roll & 3);
+    Direction best = Direction::NONE;
+    int bestScore = -1;
+    for (int n = 0; n < 4; ++n) {
+        const Direction d = static_cast<Direction>((first + n) & 3);
+        if (isOppositeDirection(d, snake.direction)) continue;
+        const int nx = x + DIRECTION_DX[static_cast<int>(d)];
+        const int ny = y + DIRECTION_DY[static_cast<int>(d)];
+        int score = 0;
+        if (nx >= 0 && nx < m_width && ny >= 0 && ny < m_height && isOpen(nx, ny)) {
+            score = isNearOtherHead(nx, ny, i) ? 1 : m_food.test(nx, ny) ? 4 : 2;
+            if (d == snake.direction && score > 1 && (roll >> 8) % 8 != 0) score++;
+        }
+        if (score > bestScore) {
+            best = d;
+            bestScore = score;
+        }
+    }
+    return best;
+}
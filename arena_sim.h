@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bitboard.h"
+#include "free_cells.h"
+#include "game_sim.h"
+#include "rng.h"
+
+
+// All snakes move together, so the arena keeps one tick interval instead of speeding up per
+// food; this is the default, servers running at another rate set theirs (setTickMicros())
+const int32_t ARENA_TICK_MICROS = 100000;
+
+// One arena snake. Cells are indices y * width + x; the body is linked through
+// ArenaSim::getNextSegment() from the tail to the head.
+struct ArenaSnake {
+    uint32_t head;
+    uint32_t tail;
+    uint32_t length;     // 0 while dead; it respawns with length 1 on the next step()
+    Direction direction;
+    uint32_t score;      // Food eaten since the last respawn
+};
+
+
+// Many snakes on one board sharing food and spike walls. A single owner grid (snake + 1 per
+// cell, 0 when free) answers every collision test, and each body is a linked list through a
+// per-cell "next segment" array, so moving, growing and shrinking a snake is O(1) no matter
+// how long it is. A step() therefore costs O(snakes), plus the length of the snakes that
+// died, which is paid once per segment ever grown.
+//
+// Collisions in a step are decided against the board as it was before the step, so like in
+// GameSim a tail that is about to move still counts as a hit. Two heads entering the same
+// cell both die. Dead snakes free their cells and respawn in a random free cell on the next
+// step. The spike walls follow the GameSim rule for the whole arena: they close in while no
+// snake has eaten for SPIKE_TIMER_MICROS and snap back whenever one eats, or when no snake is
+// left alive. Food the walls cover is placed again inside them.
+class ArenaSim {
+public:
+    // width and height must pass isValidBoardSize(); snakeCount + foodCount must leave room.
+    ArenaSim(int width, int height, size_t snakeCount, size_t foodCount, uint32_t seed = 0);
+
+    void reset(uint32_t seed);
+
+    // Game time one step() stands for, which drives the spike wall timers. Must be positive.
+    void setTickMicros(int32_t tickMicros) { m_tickMicros = tickMicros; }
+    int32_t getTickMicros() const { return m_tickMicros; }
+
+    // Moves every living snake by one cell. directions holds one entry per snake: NONE keeps
+    // the current direction (a snake that never got one waits), reversals are ignored.
+    void step(const Direction* directions);
+
+    // Safe-first bot move for snake i: mostly straight on, into adjacent food when there is
+    // some, away from cells another head could enter too, and only into a blocked cell when
+    // every choice is blocked. O(1).
+    Direction pickBotDirection(size_t i, Rng& rng) const;
+
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    size_t getSnakeCount() const { return m_snakes.size(); }
+    const ArenaSnake& getSnake(size_t i) const { return m_snakes[i]; }
+    bool isAlive(size_t i) const { return m_snakes[i].length != 0; }
+    size_t getAliveCount() const { return m_aliveCount; }
+
+    uint32_t getOwner(uint32_t cell) const { return m_owner[cell]; } // Snake index + 1, 0 when free
+    uint32_t getNextSegment(uint32_t cell) const { return m_next[cell]; } // Towards the head
+    bool isFood(uint32_t cell) const { return m_food.testCell(cell); }
+    size_t getFoodCount() const { return m_foodCount; }
+
+    int getLeftSpikeWall() const { return m_leftSpikeWall; }
+    int getRightSpikeWall() const { return m_rightSpikeWall; }
+    int getTopSpikeWall() const { return m_topSpikeWall; }
+    int getBottomSpikeWall() const { return m_bottomSpikeWall; }
+
+    // Cells whose owner or food changed in the last step(), for incremental renderers; a cell
+    // can be listed more than once. Spike wall moves are not listed.
+    const std::vector<uint32_t>& getChangedCells() const { return m_changed; }
+
+    uint64_t getTick() const { return m_tick; }
+    uint64_t getDeathCount() const { return m_deathCount; }
+    uint64_t getHeadOnCount() const { return m_headOnCount; } // Snakes lost to head-to-head hits
+
+private:
+    enum class Fate : uint8_t { WAIT, MOVE, DIE };
+
+    bool isInsideWalls(int x, int y) const {
+        return x >= m_leftSpikeWall && x < m_rightSpikeWall && y >= m_topSpikeWall && y < m_bottomSpikeWall;
+    }
+    bool isOpen(int x, int y) const; // Inside the walls and not owned
+    bool isNearOtherHead(int x, int y, size_t i) const;
+    void resetSpikeWalls();
+    void advanceSpikeWalls();
+    // Removes the food between the old walls and the current ones; step() places it again inside
+    void dropCoveredFood(int left, int right, int top, int bottom);
+    bool sampleEmptyCell(uint32_t& cell); // Free, not food, inside the walls
+    void spawnSnake(size_t i);
+    void killSnake(size_t i);
+    void occupy(uint32_t cell, size_t snake);
+    void release(uint32_t cell);
+
+    int m_width;
+    int m_height;
+    std::vector<ArenaSnake> m_snakes;
+    std::vector<uint32_t> m_owner;
+    std::vector<uint32_t> m_next;
+    FreeCellIndex m_freeCells;  // Complement of the owned cells
+    Bitboard m_food;
+    size_t m_foodCount;
+    size_t m_foodTarget;
+    size_t m_aliveCount;
+
+    // Per-step scratch: where each snake goes, and which cells a head already claimed this tick
+    std::vector<Fate> m_fate;
+    std::vector<uint32_t> m_target;
+    std::vector<uint32_t> m_claimStamp; // Claimed in this step when equal to m_stamp
+    std::vector<uint32_t> m_claimSnake;
+    uint32_t m_stamp;
+    std::vector<uint32_t> m_changed;
+
+    int32_t m_tickMicros;
+    int32_t m_foodTimer;
+    int32_t m_spikeAdvanceTimer;
+    int m_leftSpikeWall;
+    int m_rightSpikeWall;
+    int m_topSpikeWall;
+    int m_bottomSpikeWall;
+
+    uint64_t m_tick;
+    uint64_t m_deathCount;
+    uint64_t m_headOnCount;
+    Rng m_rng; // RngStream::FOOD of the seed, also places respawning snakes
+};
@@ -0,0 +1,149 @@
+#include "arena_texture.h"
+
+#include <algorithm>
+
+
+namespace {
+
+const sf::Color PLAYER_HEAD_COLOR(255, 255, 255);
+const sf::Color PLAYER_BODY_COLOR(0, 255, 255);
+const sf::Color BOT_COLORS[] = {sf::Color(0, 200, 0), sf::Color(200, 120, 255), sf::Color(255, 150, 0),
+                                sf::Color(80, 140, 255), sf::Color(255, 90, 160), sf::Color(170, 220, 60)};
+const size_t BOT_COLOR_COUNT = sizeof(BOT_COLORS) / sizeof(BOT_COLORS[0]);
+const sf::Color FOOD_COLOR(255, 0, 0);
+const sf::Color SPIKE_COLOR(255, 255, 0);
+const sf::Color EMPTY_COLOR(0, 0, 0, 0); // Lets the window clear color show through
+
+sf::Color brighter(sf::Color color) {
+    return sf::Color(static_cast<sf::Uint8>((color.r + 255) / 2), static_cast<sf::Uint8>((color.g + 255) / 2),
+                     static_cast<sf::Uint8>((color.b + 255) / 2));
+}
+
+sf::Color cellColor(const ArenaSim& arena, uint32_t cell) {
+    const uint32_t owner = arena.getOwner(cell);
+    if (owner != 0) {
+        const bool head = arena.getSnake(owner - 1).head == cell;
+        if (owner == 1) return head ? PLAYER_HEAD_COLOR : PLAYER_BODY_COLOR;
+        const sf::Color body = BOT_COLORS[(owner - 2) % BOT_COLOR_COUNT];
+        return head ? brighter(body) : body;
+    }
+    if (arena.isFood(cell)) return FOOD_COLOR;
+    const int x = static_cast<int>(cell % static_cast<uint32_t>(arena.getWidth()));
+    const int y = static_cast<int>(cell / static_cast<uint32_t>(arena.getWidth()));
+    if (x < arena.getLeftSpikeWall() || x >= arena.getRightSpikeWall() ||
+        y < arena.getTopSpikeWall() || y >= arena.getBottomSpikeWall()) return SPIKE_COLOR;
+    return EMPTY_COLOR;
+}
+
+void writeTexel(sf::Uint8* texel, sf::Color color) {
+    texel[0] = color.r;
+    texel[1] = color.g;
+    texel[2] = color.b;
+    texel[3] = color.a;
+}
+
+}
+
+
+ArenaTexture::ArenaTexture(float blockSize)
+    : m_blockSize(blockSize), m_width(0), m_height(0), m_left(0), m_right(0), m_top(0), m_bottom(0) {
+}
+
+void ArenaTexture::setBlockSize(float blockSize) {
+    m_blockSize = blockSize;
+}
+
+bool ArenaTexture::reset(const ArenaSim& arena) {
+    if (arena.getWidth() != m_width || arena.getHeight() != m_height) {
+        unsigned maxSize = sf::Texture::getMaximumSize();
+        if (static_cast<unsigned>(arena.getWidth()) > maxSize || static_cast<unsigned>(arena.getHeight()) > maxSize) return false;
+        if (!m_texture.create(arena.getWidth(), arena.getHeight())) return false;
+        m_texture.setSmooth(false); // Hard cell edges when scaled up
+        m_width = arena.getWidth();
+        m_height = arena.getHeight();
+        m_pixels.assign(static_cast<size_t>(m_width) * m_height * 4, 0);
+        m_scratch.resize(static_cast<size_t>(m_height) * 4);
+    }
+
+    const float width = m_width * m_blockSize;
+    const float height = m_height * m_blockSize;
+    m_boardQuad[0] = sf::Vertex(sf::Vector2f(0.f, 0.f), sf::Vector2f(0.f, 0.f));
+    m_boardQuad[1] = sf::Vertex(sf::Vector2f(width, 0.f), sf::Vector2f(static_cast<float>(m_width), 0.f));
+    m_boardQuad[2] = sf::Vertex(sf::Vector2f(width, height), sf::Vector2f(static_cast<float>(m_width), static_cast<float>(m_height)));
+    m_boardQuad[3] = sf::Vertex(sf::Vector2f(0.f, height), sf::Vector2f(0.f, static_cast<float>(m_height)));
+
+    repaintRows(arena, 0, m_height);
+    m_heads.resize(arena.getSnakeCount());
+    for (size_t i = 0; i < m_heads.size(); ++i) m_heads[i] = arena.getSnake(i).head;
+    m_left = arena.getLeftSpikeWall();
+    m_right = arena.getRightSpikeWall();
+    m_top = arena.getTopSpikeWall();
+    m_bottom = arena.getBottomSpikeWall();
+    return true;
+}
+
+void ArenaTexture::update(const ArenaSim& arena) {
+    // Spike walls: repaint only the band each wall moved over
+    const int top = arena.getTopSpikeWall();
+    const int bottom = arena.getBottomSpikeWall();
+    const int left = arena.getLeftSpikeWall();
+    const int right = arena.getRightSpikeWall();
+    if (top != m_top) repaintRows(arena, std::min(top, m_top), std::max(top, m_top));
+    if (bottom != m_bottom) repaintRows(arena, std::min(bottom, m_bottom), std::max(bottom, m_bottom));
+    if (left != m_left) repaintColumns(arena, std::min(left, m_left), std::max(left, m_left));
+    if (right != m_right) repaintColumns(arena, std::min(right, m_right), std::max(right, m_right));
+    m_top = top;
+    m_bottom = bottom;
+    m_left = left;
+    m_right = right;
+
+    // Owner and food changes, then the heads: an old head turns into body without changing owner
+    for (uint32_t cell : arena.getChangedCells()) paintCell(arena, cell);
+    for (size_t i = 0; i < m_heads.size(); ++i) {
+        const uint32_t head = arena.getSnake(i).head;
+        if (head == m_heads[i]) continue;
+        paintCell(arena, m_heads[i]);
+        paintCell(arena, head);
+        m_heads[i] = head;
+    }
+}
+
+void ArenaTexture::paintCell(const ArenaSim& arena, uint32_t cell) {
+    const sf::Color color = cellColor(arena, cell);
+    sf::Uint8* texel = &m_pixels[static_cast<size_t>(cell) * 4];
+    if (texel[0] == color.r && texel[1] == color.g && texel[2] == color.b && texel[3] == color.a) return;
+    writeTexel(texel, color);
+    m_texture.update(texel, 1, 1, cell % static_cast<uint32_t>(m_width), cell / static_cast<uint32_t>(m_width));
+}
+
+void ArenaTexture::repaintRows(const ArenaSim& arena, int firstRow, int endRow) {
+    firstRow = std::max(firstRow, 0);
+    endRow = std::min(endRow, m_height);
+    if (firstRow >= endRow) return;
+    for (int y = firstRow; y < endRow; ++y) {
+        const uint32_t rowStart = static_cast<uint32_t>(y) * m_width;
+        for (int x = 0; x < m_width; ++x) writeTexel(&m_pixels[(rowStart + x) * 4], cellColor(arena, rowStart + x));
+    }
+    // Whole rows are contiguous in m_pixels, so the band goes up in one call
+    m_texture.update(&m_pixels[static_cast<size_t>(firstRow) * m_width * 4], m_width, endRow - firstRow, 0, firstRow);
+}
+
+void ArenaTexture::repaintColumns(const ArenaSim& arena, int firstColumn, int endColumn) {
+    firstColumn = std::max(firstColumn, 0);
+    endColumn = std::min(endColumn, m_width);
+    for (int x = firstColumn; x < endColumn; ++x) {
+        for (int y = 0; y < m_height; ++y) {
+            const uint32_t cell = static_cast<uint32_t>(y) * m_width + x;
+            const sf::Color color = cellColor(arena, cell);
+            writeTexel(&m_pixels[static_cast<size_t>(cell) * 4], color);
+            writeTexel(&m_scratch[static_cast<size_t>(y) * 4], color);
+        }
+        m_texture.update(m_scratch.data(), 1, m_height, x, 0);
+    }
+}
+
+void ArenaTexture::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    if (m_width == 0) return;
+    states.texture = &m_texture;
+    target.draw(m_boardQuad, 4, sf::Quads, states);
+}
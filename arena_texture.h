@@ -0,0 +1,47 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "arena_sim.h"
+
+
+// An ArenaSim board as a width x height texture, one texel per cell, drawn as a single scaled
+// quad. After reset() update() repaints only the cells the last step changed, every snake's
+// previous and current head, and the bands the spike walls moved over, so a frame costs
+// O(snakes) however large the board is. Snake 0 (the player) gets its own colour; the bots
+// share a small palette.
+class ArenaTexture : public sf::Drawable {
+public:
+    explicit ArenaTexture(float blockSize);
+
+    void setBlockSize(float blockSize);
+
+    // Uploads the full board; false if the board exceeds the GPU texture size limit.
+    bool reset(const ArenaSim& arena);
+
+    // Call after every ArenaSim::step() to bring the texels in line with arena.
+    void update(const ArenaSim& arena);
+
+private:
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+    void paintCell(const ArenaSim& arena, uint32_t cell);
+    void repaintRows(const ArenaSim& arena, int firstRow, int endRow);
+    void repaintColumns(const ArenaSim& arena, int firstColumn, int endColumn);
+
+    float m_blockSize;
+    int m_width;
+    int m_height;
+    sf::Texture m_texture;
+    std::vector<sf::Uint8> m_pixels;  // CPU copy of the texture, RGBA per cell
+    std::vector<sf::Uint8> m_scratch; // Column uploads are gathered here
+    sf::Vertex m_boardQuad[4];
+
+    // State the texels currently show
+    std::vector<uint32_t> m_heads;
+    int m_left;
+    int m_right;
+    int m_top;
+    int m_bottom;
+};
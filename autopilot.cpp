@@ -0,0 +1,188 @@
+#include "autopilot.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+
+namespace {
+
+// Neighbour offsets in Direction order (UP, DOWN, LEFT, RIGHT)
+const int DIRECTION_DX[4] = {0, 0, -1, 1};
+const int DIRECTION_DY[4] = {-1, 1, 0, 0};
+
+// After a failed search, one decision is skipped per this many expanded nodes, so the average
+// cost of chasing unreachable food on a huge board stays near that of a few thousand nodes
+const uint32_t RETRY_EXPANSIONS_PER_DECISION = 4096;
+
+}
+
+
+Autopilot::Autopilot()
+    : m_width(0),
+      m_height(0),
+      m_stamp(0),
+      m_pathPos(0),
+      m_pathStart{-1, -1},
+      m_pathFood{-1, -1},
+      m_pathWalls{0, 0, 0, 0},
+      m_expanded(0),
+      m_retryIn(0),
+      m_failedFood{-1, -1},
+      m_planCount(0),
+      m_decisionCount(0) {
+}
+
+void Autopilot::resize(int width, int height) {
+    m_width = width;
+    m_height = height;
+    const size_t cells = static_cast<size_t>(width) * height;
+    m_nodeStamp.assign(cells, 0);
+    m_nodeCost.assign(cells, 0);
+    m_nodeParent.assign(cells, 0);
+    m_stamp = 0;
+    m_path.clear();
+}
+
+Direction Autopilot::decide(const GameSim& sim) {
+    m_decisionCount++;
+    if (sim.getWidth() != m_width || sim.getHeight() != m_height) resize(sim.getWidth(), sim.getHeight());
+    if (isPathValid(sim)) return directionTo(sim.getSnake().front(), m_path[m_pathPos]);
+    if (m_retryIn > 0 && sim.getFood() == m_failedFood) {
+        m_retryIn--;
+        return fallback(sim);
+    }
+    if (plan(sim)) {
+        m_retryIn = 0;
+        return directionTo(sim.getSnake().front(), m_path[m_pathPos]);
+    }
+    m_failedFood = sim.getFood();
+    m_retryIn = m_expanded / RETRY_EXPANSIONS_PER_DECISION;
+    return fallback(sim);
+}
+
+bool Autopilot::isPathValid(const GameSim& sim) {
+    const Point head = sim.getSnake().front();
+    const uint32_t headCell = static_cast<uint32_t>(head.y * m_width + head.x);
+    if (m_pathPos < m_path.size() && headCell == m_path[m_pathPos]) ++m_pathPos; // Moved as planned
+    if (m_pathPos >= m_path.size()) return false;
+
+    // The cells ahead were free when planned and only the head moves onto them, so the path
+    // stays valid while the snake is where the plan expects it and food and walls are unchanged
+    const bool onPath = m_pathPos == 0 ? head == m_pathStart : headCell == m_path[m_pathPos - 1];
+    return onPath && sim.getFood() == m_pathFood && sim.getLeftSpikeWall() == m_pathWalls[0] &&
+           sim.getRightSpikeWall() == m_pathWalls[1] && sim.getTopSpikeWall() == m_pathWalls[2] &&
+           sim.getBottomSpikeWall() == m_pathWalls[3];
+}
+
+bool Autopilot::plan(const GameSim& sim) {
+    m_planCount++;
+    m_path.clear();
+    m_pathPos = 0;
+    m_expanded = 0;
+    const Point food = sim.getFood();
+    if (food.x < 0) return false; // Board is full
+    if (food.x < sim.getLeftSpikeWall() || food.x >= sim.getRightSpikeWall() || food.y < sim.getTopSpikeWall() ||
+        food.y >= sim.getBottomSpikeWall()) {
+        return false; // Food is under the spikes
+    }
+
+    if (++m_stamp == 0) { // Stamp wrapped, forget every node
+        std::fill(m_nodeStamp.begin(), m_nodeStamp.end(), 0);
+        m_stamp = 1;
+    }
+    const Bitboard& occupied = sim.getOccupancy();
+    const int left = sim.getLeftSpikeWall();
+    const int right = sim.getRightSpikeWall();
+    const int top = sim.getTopSpikeWall();
+    const int bottom = sim.getBottomSpikeWall();
+    const Point head = sim.getSnake().front();
+    const Direction current = sim.getDirection();
+    const uint32_t foodCell = static_cast<uint32_t>(food.y * m_width + food.x);
+    const uint32_t headCell = static_cast<uint32_t>(head.y * m_width + head.x);
+
+    m_openNow.clear();
+    m_openNext.clear();
+    int f = std::abs(food.x - head.x) + std::abs(food.y - head.y);
+    m_nodeStamp[headCell] = m_stamp;
+    m_nodeCost[headCell] = CLOSED;
+
+    uint32_t cell = headCell;
+    uint32_t cost = 0;
+    for (;;) {
+        // Expand cell: neighbours inside the walls and off the body, unless already reached
+        // with no more steps. Reversing from the head is not a move.
+        const int x = static_cast<int>(cell % m_width);
+        const int y = static_cast<int>(cell / m_width);
+        for (int d = 0; d < 4; ++d) {
+            if (cell == headCell && isOppositeDirection(static_cast<Direction>(d), current)) continue;
+            const int nx = x + DIRECTION_DX[d];
+            const int ny = y + DIRECTION_DY[d];
+            if (nx < left || nx >= right || ny < top || ny >= bottom) continue;
+            const uint32_t next = static_cast<uint32_t>(ny * m_width + nx);
+            if (occupied.testCell(next)) continue;
+            if (m_nodeStamp[next] == m_stamp && ((m_nodeCost[next] & CLOSED) || m_nodeCost[next] <= cost + 1)) continue;
+            m_nodeStamp[next] = m_stamp;
+            m_nodeCost[next] = cost + 1;
+            m_nodeParent[next] = static_cast<uint8_t>(d);
+            const int nextF = static_cast<int>(cost + 1) + std::abs(food.x - nx) + std::abs(food.y - ny);
+            (nextF == f ? m_openNow : m_openNext).push_back(next);
+        }
+
+        // Pop the newest open node with the lowest f; stale duplicates are already closed
+        do {
+            if (m_openNow.empty()) {
+                if (m_openNext.empty()) return false; // Food is unreachable
+                m_openNow.swap(m_openNext);
+                f += 2;
+            }
+            cell = m_openNow.back();
+            m_openNow.pop_back();
+        } while (m_nodeCost[cell] & CLOSED);
+        cost = m_nodeCost[cell];
+        m_nodeCost[cell] |= CLOSED;
+        m_expanded++;
+        if (cell == foodCell) break;
+    }
+
+    // Follow the parents back from the food
+    m_path.resize(cost);
+    for (uint32_t i = cost; i-- > 0;) {
+        m_path[i] = cell;
+        const int d = m_nodeParent[cell];
+        cell = static_cast<uint32_t>((static_cast<int>(cell / m_width) - DIRECTION_DY[d]) * m_width +
+                                     static_cast<int>(cell % m_width) - DIRECTION_DX[d]);
+    }
+    m_pathStart = head;
+    m_pathFood = food;
+    m_pathWalls[0] = left;
+    m_pathWalls[1] = right;
+    m_pathWalls[2] = top;
+    m_pathWalls[3] = bottom;
+    return true;
+}
+
+Direction Autopilot::fallback(const GameSim& sim) const {
+    const Point head = sim.getSnake().front();
+    const Direction current = sim.getDirection();
+    const int first = current == Direction::NONE ? 0 : static_cast<int>(current);
+    for (int n = 0; n < 4; ++n) {
+        const Direction d = static_cast<Direction>((first + n) % 4);
+        if (isOppositeDirection(d, current)) continue;
+        const int x = head.x + DIRECTION_DX[static_cast<int>(d)];
+        const int y = head.y + DIRECTION_DY[static_cast<int>(d)];
+        if (x < sim.getLeftSpikeWall() || x >= sim.getRightSpikeWall() || y < sim.getTopSpikeWall() ||
+            y >= sim.getBottomSpikeWall() || sim.getOccupancy().test(x, y)) {
+            continue;
+        }
+        return d;
+    }
+    return Direction::NONE; // Boxed in
+}
+
+Direction Autopilot::directionTo(Point from, uint32_t cell) const {
+    const int x = static_cast<int>(cell % m_width);
+    const int y = static_cast<int>(cell / m_width);
+    if (x > from.x) return Direction::RIGHT;
+    if (x < from.x) return Direction::LEFT;
+    return y > from.y ? Direction::DOWN : Direction::UP;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "game_sim.h"
+
+
+// Steers a GameSim towards the food along a shortest path that avoids the body and the current
+// spike walls. Paths are found with A* (Manhattan distance) over the sim's occupancy bitboard.
+// On a grid with unit steps a node's f grows by 0 or 2, so the open list is just two stacks
+// (f and f + 2); popping the newest node first heads straight for the food on open boards.
+// A planned path is reused until the food, the walls or the head position stop matching it,
+// so most decisions are O(1). When the food cannot be reached it picks any safe neighbour,
+// preferring to keep going straight, and waits longer before searching again the more cells
+// the failed search covered.
+class Autopilot {
+public:
+    Autopilot();
+
+    // Direction for the next step() of sim. Call once per step.
+    Direction decide(const GameSim& sim);
+
+    // Drops the cached path, the next decide() plans again.
+    void reset() {
+        m_path.clear();
+        m_retryIn = 0;
+    }
+
+    uint64_t getPlanCount() const { return m_planCount; }
+    uint64_t getDecisionCount() const { return m_decisionCount; }
+
+private:
+    static const uint32_t CLOSED = 0x80000000u; // Set in m_nodeCost once a node is expanded
+
+    void resize(int width, int height);
+    bool isPathValid(const GameSim& sim);
+    bool plan(const GameSim& sim);
+    Direction fallback(const GameSim& sim) const;
+    Direction directionTo(Point from, uint32_t cell) const;
+
+    int m_width;
+    int m_height;
+
+    // Per-cell search state, valid only where m_nodeStamp equals m_stamp (no clearing per plan)
+    std::vector<uint32_t> m_nodeStamp;
+    std::vector<uint32_t> m_nodeCost;   // Steps from the head, plus CLOSED
+    std::vector<uint8_t> m_nodeParent;  // Direction the node was entered with
+    uint32_t m_stamp;
+    std::vector<uint32_t> m_openNow;    // Open cells with the current f
+    std::vector<uint32_t> m_openNext;   // Open cells with f + 2
+
+    std::vector<uint32_t> m_path;       // Cells from the first step to the food
+    size_t m_pathPos;                   // Index of the next cell to enter
+    Point m_pathStart;
+    Point m_pathFood;
+    int m_pathWalls[4];
+
+    uint32_t m_expanded;                // Nodes expanded by the last plan()
+    uint32_t m_retryIn;                 // Decisions to skip planning after a failed plan
+    Point m_failedFood;
+
+    uint64_t m_planCount;
+    uint64_t m_decisionCount;
+};
@@ -0,0 +1,70 @@
+#include "batch_runner.h"
+
+#include <algorithm>
+#include <chrono>
+
+
+BatchRunner::BatchRunner(size_t gameCount, uint32_t seed, unsigned threadCount, int width, int height,
+                         BatchPolicy policy)
+    : m_policy(policy), m_pool(threadCount) {
+    m_games.reserve(gameCount);
+    for (size_t i = 0; i < gameCount; ++i) {
+        uint32_t gameSeed = deriveSeed(seed, static_cast<uint32_t>(i));
+        m_games.push_back({GameSim(gameSeed, width, height), Rng(gameSeed, RngStream::POLICY), Autopilot(),
+                           HamiltonianSolver(), 0, 0, 0});
+        if (policy == BatchPolicy::HAMILTONIAN) m_games.back().sim.setSpikesEnabled(false);
+    }
+}
+
+BatchStats BatchRunner::run(uint64_t ticksPerGame) {
+    for (Instance& game : m_games) {
+        game.ticks = 0;
+        game.gamesFinished = 0;
+        game.totalScore = 0;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    const size_t chunkCount = (m_games.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    m_pool.parallelFor(chunkCount, [&](size_t chunk, unsigned) { runChunk(chunk, ticksPerGame); });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    BatchStats stats = {0, 0, 0, seconds};
+    for (const Instance& game : m_games) {
+        stats.ticks += game.ticks;
+        stats.gamesFinished += game.gamesFinished;
+        stats.totalScore += game.totalScore;
+    }
+    return stats;
+}
+
+void BatchRunner::runChunk(size_t chunk, uint64_t ticksPerGame) {
+    const size_t begin = chunk * CHUNK_SIZE;
+    const size_t end = std::min(begin + CHUNK_SIZE, m_games.size());
+    for (size_t i = begin; i < end; ++i) {
+        Instance& game = m_games[i];
+        for (uint64_t t = 0; t < ticksPerGame; ++t) {
+            if (game.sim.step(decide(game)) == StepResult::DIED) {
+                game.gamesFinished++;
+                game.totalScore += game.sim.getScore();
+                game.sim.reset(game.policyRng.next());
+            }
+            game.ticks++;
+        }
+    }
+}
+
+Direction BatchRunner::decide(Instance& game) const {
+    switch (m_policy) {
+        case BatchPolicy::AUTOPILOT:   return game.autopilot.decide(game.sim);
+        case BatchPolicy::HAMILTONIAN: return game.solver.decide(game.sim);
+        case BatchPolicy::RANDOM:      break;
+    }
+    return randomPolicy(game);
+}
+
+Direction BatchRunner::randomPolicy(Instance& game) {
+    // Keep going straight most of the time, otherwise pick any direction
+    uint32_t roll = game.policyRng.next();
+    if (game.sim.getDirection() != Direction::NONE && (roll & 3) != 0) return Direction::NONE;
+    return static_cast<Direction>((roll >> 8) & 3);
+}
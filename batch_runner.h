@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "autopilot.h"
+#include "game_sim.h"
+#include "hamiltonian_solver.h"
+#include "rng.h"
+#include "thread_pool.h"
+
+
+// How the batch picks each game's moves. HAMILTONIAN turns spikes off so games run until the
+// board is full.
+enum class BatchPolicy { RANDOM, AUTOPILOT, HAMILTONIAN };
+
+struct BatchStats {
+    uint64_t ticks;          // Steps taken across all games
+    uint64_t gamesFinished;  // Games that died and were restarted
+    uint64_t totalScore;     // Sum of final scores of finished games
+    double seconds;
+
+    double ticksPerSecond() const { return seconds > 0.0 ? ticks / seconds : 0.0; }
+};
+
+
+// Steps many independent GameSim instances on a WorkStealingPool. Every instance owns its
+// simulation and policy RNG (seeded from the batch seed and its index), finished games are
+// restarted in place, and games are handed to workers in chunks of CHUNK_SIZE.
+class BatchRunner {
+public:
+    BatchRunner(size_t gameCount, uint32_t seed, unsigned threadCount = 0, int width = DEFAULT_GRID_WIDTH,
+                int height = DEFAULT_GRID_HEIGHT, BatchPolicy policy = BatchPolicy::RANDOM);
+
+    // Advances every game by ticksPerGame steps.
+    BatchStats run(uint64_t ticksPerGame);
+
+    size_t getGameCount() const { return m_games.size(); }
+    unsigned getThreadCount() const { return m_pool.getThreadCount(); }
+    const GameSim& getGame(size_t i) const { return m_games[i].sim; }
+    GameSim& getGame(size_t i) { return m_games[i].sim; } // E.g. to load a save state between runs
+
+private:
+    static const size_t CHUNK_SIZE = 64;
+
+    struct Instance {
+        GameSim sim;
+        Rng policyRng; // RngStream::POLICY of the game's seed
+        Autopilot autopilot; // Allocates on first use, so only with BatchPolicy::AUTOPILOT
+        HamiltonianSolver solver; // Shares the cached cycle of the board size
+        uint64_t ticks;
+        uint64_t gamesFinished;
+        uint64_t totalScore;
+    };
+
+    void runChunk(size_t chunk, uint64_t ticksPerGame);
+    Direction decide(Instance& game) const;
+    static Direction randomPolicy(Instance& game);
+
+    std::vector<Instance> m_games;
+    BatchPolicy m_policy;
+    WorkStealingPool m_pool;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "game_sim.h"
+
+
+using BenchClock = std::chrono::steady_clock;
+
+const double MIN_BENCH_SECONDS = 0.2;
+
+// Results are written here so the optimizer cannot drop the measured work
+extern volatile uint32_t benchSink;
+
+inline double secondsSince(BenchClock::time_point start) {
+    return std::chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+// Runs body() in batches until MIN_BENCH_SECONDS have passed, returns nanoseconds per call.
+template <typename Body>
+double measureNs(Body body) {
+    const int batch = 256;
+    long long calls = 0;
+    BenchClock::time_point start = BenchClock::now();
+    double elapsed;
+    do {
+        for (int i = 0; i < batch; ++i) body();
+        calls += batch;
+        elapsed = secondsSince(start);
+    } while (elapsed < MIN_BENCH_SECONDS);
+    return elapsed * 1e9 / calls;
+}
+
+// Next move along a fixed Hamiltonian cycle (height must be even): rows are swept in a
+// serpentine over columns 1..width-1 and column 0 leads back up to the first row. With spikes
+// off a snake following it never dies and fills the board.
+inline Direction cycleDirection(Point p, int width, int height) {
+    if (p.x == 0) return p.y > 0 ? Direction::UP : Direction::RIGHT;
+    if (p.y % 2 == 0) return p.x < width - 1 ? Direction::RIGHT : Direction::DOWN;
+    if (p.x > 1) return Direction::LEFT;
+    return p.y < height - 1 ? Direction::DOWN : Direction::LEFT;
+}
+
+
+// One measured number: suite and case identify it across runs, so results of two commits can
+// be joined on (suite, case, metric).
+struct BenchResult {
+    std::string suite;
+    std::string caseName;
+    std::string metric;
+    double value;
+    std::string unit;
+};
+
+class BenchReport {
+public:
+    void add(const std::string& suite, const std::string& caseName, const std::string& metric, double value,
+             const std::string& unit);
+    void setMeta(const std::string& key, const std::string& value);
+
+    void writeTable(FILE* out) const;
+    void writeCsv(FILE* out) const;
+    void writeJson(FILE* out) const;
+
+private:
+    std::vector<BenchResult> m_results;
+    std::vector<std::pair<std::string, std::string>> m_meta;
+};
+
+
+#if defined(SNAKE_BENCH_RENDER)
+// Offscreen frame rendering (bench/render_bench.cpp), only built together with the game.
+void benchRender(BenchReport& report);
+#endif
@@ -0,0 +1,103 @@
+// Full-frame rendering into an offscreen sf::RenderTexture, with the game's drawables.
+// Only compiled when the game (and so SFML) is built.
+#include <SFML/Graphics.hpp>
+#include <cstdio>
+
+#include "bench_common.h"
+#include "board_texture.h"
+#include "snake_mesh.h"
+#include "spike_mesh.h"
+
+
+namespace {
+
+const float RENDER_BLOCK_SIZE = 8.f;
+const int RENDER_FRAMES = 600;
+
+// Grows a spike-free snake along the Hamiltonian cycle until it covers fill of the board.
+void growSnake(GameSim& sim, double fill) {
+    const size_t target = static_cast<size_t>(fill * sim.getWidth() * sim.getHeight());
+    while (sim.getSnake().size() < target && sim.isAlive()) {
+        sim.step(cycleDirection(sim.getSnake().front(), sim.getWidth(), sim.getHeight()));
+    }
+}
+
+// Renders RENDER_FRAMES frames with one tick per frame; returns frames per second or 0 when no
+// render texture could be created (e.g. no GL context on a display-less machine).
+double renderFrames(int width, int height, double fill, bool tilemap) {
+    sf::RenderTexture target;
+    if (!target.create(static_cast<unsigned>(width * RENDER_BLOCK_SIZE), static_cast<unsigned>(height * RENDER_BLOCK_SIZE))) {
+        return 0.0;
+    }
+
+    GameSim sim(11, width, height);
+    sim.setSpikesEnabled(false);
+    growSnake(sim, fill);
+
+    SnakeMesh snakeMesh(RENDER_BLOCK_SIZE);
+    SpikeMesh spikeMesh(RENDER_BLOCK_SIZE);
+    BoardTexture board(RENDER_BLOCK_SIZE);
+    snakeMesh.reset(sim.getSnake());
+    if (tilemap && !board.reset(sim)) return 0.0;
+
+    sf::CircleShape food(RENDER_BLOCK_SIZE / 2.f);
+    food.setFillColor(sf::Color::Red);
+    sf::VertexArray gridLines(sf::Lines);
+    const sf::Color gridColor(50, 50, 50);
+    for (int x = 0; x <= width; ++x) {
+        gridLines.append(sf::Vertex(sf::Vector2f(x * RENDER_BLOCK_SIZE, 0.f), gridColor));
+        gridLines.append(sf::Vertex(sf::Vector2f(x * RENDER_BLOCK_SIZE, height * RENDER_BLOCK_SIZE), gridColor));
+    }
+    for (int y = 0; y <= height; ++y) {
+        gridLines.append(sf::Vertex(sf::Vector2f(0.f, y * RENDER_BLOCK_SIZE), gridColor));
+        gridLines.append(sf::Vertex(sf::Vector2f(width * RENDER_BLOCK_SIZE, y * RENDER_BLOCK_SIZE), gridColor));
+    }
+
+    BenchClock::time_point start = BenchClock::now();
+    for (int frame = 0; frame < RENDER_FRAMES; ++frame) {
+        StepResult result = sim.step(cycleDirection(sim.getSnake().front(), width, height));
+        if (result == StepResult::ATE || result == StepResult::MOVED) snakeMesh.pushHead(sim.getSnake().front());
+        if (result == StepResult::MOVED) snakeMesh.popTail();
+
+        target.clear(sf::Color(20, 20, 20));
+        if (tilemap) {
+            board.update(sim);
+            target.draw(board);
+        } else {
+            target.draw(gridLines);
+            Point foodCell = sim.getFood();
+            food.setPosition(foodCell.x * RENDER_BLOCK_SIZE, foodCell.y * RENDER_BLOCK_SIZE);
+            target.draw(food);
+            spikeMesh.update(sim);
+            target.draw(spikeMesh);
+            snakeMesh.setInterpolation(0.5f);
+            target.draw(snakeMesh);
+        }
+        target.display();
+    }
+    // Reading the result back waits for the GPU to finish the queued frames
+    benchSink = target.getTexture().copyToImage().getSize().x;
+    return RENDER_FRAMES / secondsSince(start);
+}
+
+}
+
+
+void benchRender(BenchReport& report) {
+    const int sizes[][2] = {{25, 20}, {100, 100}, {250, 250}};
+    const double fills[] = {0.05, 0.5, 0.95};
+    for (const auto& size : sizes) {
+        for (double fill : fills) {
+            for (bool tilemap : {false, true}) {
+                double fps = renderFrames(size[0], size[1], fill, tilemap);
+                if (fps <= 0.0) {
+                    report.add("render", "unavailable", "no render texture", 0.0, "");
+                    return;
+                }
+                char caseName[64];
+                std::snprintf(caseName, sizeof(caseName), "%dx%d fill=%.3f", size[0], size[1], fill);
+                report.add("render", caseName, tilemap ? "tilemap" : "shapes", fps, "frames/s");
+            }
+        }
+    }
+}
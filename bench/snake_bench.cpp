@@ -0,0 +1,640 @@
+// Benchmarks for the hot paths. Build in Release and run:
+//   snake_bench [--format table|csv|json] [--out file] [--suite name]...
+// Suites: spawn, lockstep, board_size, tick_length, particles, rng, autopilot, hamiltonian, env, arena, spectator, save_state,
+// render (render only when built with the game, see CMakeLists.txt).
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "arena_sim.h"
+#include "autopilot.h"
+#include "bench_common.h"
+#include "bitboard.h"
+#include "free_cells.h"
+#include "game_sim.h"
+#include "hamiltonian_solver.h"
+#include "lockstep_sim.h"
+#include "particles.h"
+#include "rng.h"
+#include "save_state.h"
+#include "snake_env.h"
+#include "spectator_writer.h"
+
+
+volatile uint32_t benchSink;
+
+
+void BenchReport::add(const std::string& suite, const std::string& caseName, const std::string& metric, double value,
+                      const std::string& unit) {
+    m_results.push_back({suite, caseName, metric, value, unit});
+}
+
+void BenchReport::setMeta(const std::string& key, const std::string& value) {
+    m_meta.emplace_back(key, value);
+}
+
+void BenchReport::writeTable(FILE* out) const {
+    std::string suite;
+    for (const BenchResult& result : m_results) {
+        if (result.suite != suite) {
+            suite = result.suite;
+            std::fprintf(out, "\n[%s]\n", suite.c_str());
+        }
+        std::fprintf(out, "  %-24s %-16s %14.2f %s\n", result.caseName.c_str(), result.metric.c_str(), result.value,
+                     result.unit.c_str());
+    }
+}
+
+void BenchReport::writeCsv(FILE* out) const {
+    std::fprintf(out, "suite,case,metric,value,unit\n");
+    for (const BenchResult& result : m_results) {
+        std::fprintf(out, "%s,%s,%s,%.6g,%s\n", result.suite.c_str(), result.caseName.c_str(), result.metric.c_str(),
+                     result.value, result.unit.c_str());
+    }
+}
+
+namespace {
+
+std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+}
+
+void BenchReport::writeJson(FILE* out) const {
+    std::fprintf(out, "{\n  \"meta\": {");
+    for (size_t i = 0; i < m_meta.size(); ++i) {
+        std::fprintf(out, "%s\n    %s: %s", i ? "," : "", jsonString(m_meta[i].first).c_str(),
+                     jsonString(m_meta[i].second).c_str());
+    }
+    std::fprintf(out, "\n  },\n  \"results\": [");
+    for (size_t i = 0; i < m_results.size(); ++i) {
+        const BenchResult& result = m_results[i];
+        std::fprintf(out, "%s\n    {\"suite\": %s, \"case\": %s, \"metric\": %s, \"value\": %.6g, \"unit\": %s}", i ? "," : "",
+                     jsonString(result.suite).c_str(), jsonString(result.caseName).c_str(),
+                     jsonString(result.metric).c_str(), result.value, jsonString(result.unit).c_str());
+    }
+    std::fprintf(out, "\n  ]\n}\n");
+}
+
+
+namespace {
+
+std::string boardName(int width, int height) {
+    return std::to_string(width) + "x" + std::to_string(height);
+}
+
+// Food spawn cost vs. board fill: free-cell index against the old rejection sampling.
+void benchSpawn(BenchReport& report) {
+    const int width = 100;
+    const int height = 100;
+    const size_t cells = static_cast<size_t>(width) * height;
+    const double fillRatios[] = {0.0, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999};
+
+    Rng rng(12345);
+    std::vector<uint32_t> order(cells);
+    std::iota(order.begin(), order.end(), 0u);
+
+    for (double ratio : fillRatios) {
+        std::shuffle(order.begin(), order.end(), rng);
+        size_t occupiedCount = static_cast<size_t>(ratio * cells);
+
+        Bitboard occupied(width, height);
+        FreeCellIndex freeCells(cells);
+        for (size_t i = 0; i < occupiedCount; ++i) {
+            occupied.setCell(order[i]);
+            freeCells.occupy(order[i]);
+        }
+
+        double indexNs = measureNs([&] { benchSink = freeCells.sample(rng); });
+
+        double rejectNs = measureNs([&] {
+            int x, y;
+            do {
+                x = static_cast<int>(rng.nextBelow(width));
+                y = static_cast<int>(rng.nextBelow(height));
+            } while (occupied.test(x, y));
+            benchSink = static_cast<uint32_t>(occupied.cellIndex(x, y));
+        });
+
+        char caseName[48];
+        std::snprintf(caseName, sizeof(caseName), "%s fill=%.3f", boardName(width, height).c_str(), ratio);
+        report.add("spawn", caseName, "index", indexNs, "ns/spawn");
+        report.add("spawn", caseName, "rejection", rejectNs, "ns/spawn");
+    }
+}
+
+// Games stepped per second: one GameSim per game vs. LockstepSim (scalar lanes and SIMD lanes).
+// Every engine sees the same per-game input stream and restarts dead games with the same seed;
+// the checksums must agree.
+void benchLockstep(BenchReport& report) {
+    const size_t games = 1024;
+    const int ticks = 2000;
+    const std::string caseName = std::to_string(games) + " games " + boardName(DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT);
+
+    // Pre-generated inputs so the policy does not show up in the timings
+    std::vector<Direction> inputs(games * ticks);
+    Rng rng(777, RngStream::POLICY);
+    for (Direction& input : inputs) {
+        uint32_t roll = rng.next();
+        input = (roll % 4 != 0) ? Direction::NONE : static_cast<Direction>((roll >> 8) % 4);
+    }
+
+    {
+        std::vector<GameSim> sims;
+        for (size_t i = 0; i < games; ++i) sims.emplace_back(static_cast<unsigned>(i));
+        long long checksum = 0;
+        BenchClock::time_point start = BenchClock::now();
+        for (int t = 0; t < ticks; ++t) {
+            const Direction* tickInputs = &inputs[static_cast<size_t>(t) * games];
+            for (size_t i = 0; i < games; ++i) {
+                if (sims[i].step(tickInputs[i]) == StepResult::DIED) {
+                    checksum += sims[i].getScore() + 1;
+                    sims[i].reset(static_cast<unsigned>(t));
+                }
+            }
+        }
+        double seconds = secondsSince(start);
+        report.add("lockstep", caseName, "GameSim", games * ticks / seconds, "game-steps/s");
+        report.add("lockstep", caseName, "GameSim checksum", static_cast<double>(checksum), "");
+    }
+
+    for (bool forceScalar : {true, false}) {
+        LockstepSim lockstep(games, forceScalar);
+        std::vector<StepResult> results(games);
+        long long checksum = 0;
+        BenchClock::time_point start = BenchClock::now();
+        for (int t = 0; t < ticks; ++t) {
+            lockstep.step(&inputs[static_cast<size_t>(t) * games], results.data());
+            for (size_t i = 0; i < games; ++i) {
+                if (results[i] == StepResult::DIED) {
+                    checksum += lockstep.getScore(i) + 1;
+                    lockstep.resetGame(i, static_cast<unsigned>(t));
+                }
+            }
+        }
+        double seconds = secondsSince(start);
+        std::string backend = lockstep.getBackendName();
+        report.add("lockstep", caseName, backend, games * ticks / seconds, "game-steps/s");
+        report.add("lockstep", caseName, backend + " checksum", static_cast<double>(checksum), "");
+    }
+}
+
+// Cost vs. board size: construction allocates for the whole board once, after that a tick
+// (move, collision, spawn, wall advance) and a reset should stay flat as the area grows.
+void benchBoardSize(BenchReport& report) {
+    const int sizes[][2] = {{25, 20}, {100, 100}, {250, 250}, {500, 500}, {1000, 1000}, {2000, 2000}};
+    const int ticks = 200000;
+
+    for (const auto& size : sizes) {
+        BenchClock::time_point setupStart = BenchClock::now();
+        GameSim sim(1, size[0], size[1]);
+        double setupMs = secondsSince(setupStart) * 1e3;
+
+        // Head for the food, x first; dead games restart with the next seed
+        unsigned seed = 1;
+        BenchClock::time_point start = BenchClock::now();
+        for (int t = 0; t < ticks; ++t) {
+            Point head = sim.getSnake().front();
+            Point food = sim.getFood();
+            Direction dir = food.x > head.x ? Direction::RIGHT : food.x < head.x ? Direction::LEFT
+                          : food.y > head.y ? Direction::DOWN : Direction::UP;
+            if (sim.step(dir) == StepResult::DIED) sim.reset(++seed);
+        }
+        double tickNs = secondsSince(start) * 1e9 / ticks;
+        double resetNs = measureNs([&] {
+            sim.reset(++seed);
+            benchSink = static_cast<uint32_t>(sim.getFood().x);
+        });
+
+        std::string caseName = boardName(size[0], size[1]);
+        report.add("board_size", caseName, "setup", setupMs, "ms");
+        report.add("board_size", caseName, "tick", tickNs, "ns/tick");
+        report.add("board_size", caseName, "reset", resetNs, "ns/reset");
+    }
+}
+
+// Tick cost vs. snake length: the snake follows a Hamiltonian cycle with spikes off, so it
+// never dies and grows from 1 cell until the board is full. Time is charged to the length
+// bucket the snake was in.
+void benchTickByLength(BenchReport& report) {
+    const int width = 64;
+    const int height = 64;
+    const size_t cells = static_cast<size_t>(width) * height;
+    const double bucketEnds[] = {0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 1.0}; // Fractions of the board
+
+    GameSim sim(3, width, height);
+    sim.setSpikesEnabled(false);
+
+    size_t bucket = 0;
+    long long bucketTicks = 0;
+    size_t bucketStartLength = 1;
+    BenchClock::time_point bucketStart = BenchClock::now();
+    while (bucket < sizeof(bucketEnds) / sizeof(bucketEnds[0])) {
+        size_t length = sim.getSnake().size();
+        bool full = length == cells;
+        if (full || length >= bucketEnds[bucket] * cells) {
+            double ns = bucketTicks ? secondsSince(bucketStart) * 1e9 / bucketTicks : 0.0;
+            char caseName[48];
+            std::snprintf(caseName, sizeof(caseName), "%s len %zu-%zu", boardName(width, height).c_str(),
+                          bucketStartLength, length);
+            if (bucketTicks) report.add("tick_length", caseName, "tick", ns, "ns/tick");
+            ++bucket;
+            bucketTicks = 0;
+            bucketStartLength = length;
+            if (full) break;
+            bucketStart = BenchClock::now();
+        }
+        sim.step(cycleDirection(sim.getSnake().front(), width, height));
+        ++bucketTicks;
+    }
+    report.add("tick_length", boardName(width, height), "final length", static_cast<double>(sim.getSnake().size()), "cells");
+}
+
+// Death burst cost: spawning a full-board snake's worth of particles and integrating them
+// until they all expire.
+void benchParticles(BenchReport& report) {
+    const size_t counts[] = {1000, 15000, 200000};
+    for (size_t count : counts) {
+        ParticlePool pool(count);
+        Rng rng(99, RngStream::POLICY);
+
+        double spawnNs = measureNs([&] {
+            pool.clear();
+            for (size_t i = 0; i < count; ++i) {
+                pool.spawn(100.f, 100.f, rng.nextRange(-50.f, 50.f), rng.nextRange(-50.f, 50.f), rng.nextRange(0.4f, 0.8f), 0x00C800);
+            }
+        }) / count;
+
+        // The game's path: one burst per segment, random values generated in batches
+        Rng burstRng(99, RngStream::PARTICLES);
+        double burstNs = measureNs([&] {
+            pool.clear();
+            for (size_t spawned = 0; spawned < count; spawned += 15) {
+                pool.spawnBurst(100.f, 100.f, 15, 50.f, 150.f, 0.4f, 0.8f, 0x00C800, burstRng);
+            }
+        }) / count;
+
+        // Update a live pool at a fixed 60 Hz step; respawn (untimed) whenever it runs dry
+        const float dt = 1.f / 60.f;
+        long long updated = 0;
+        double updateSeconds = 0.0;
+        while (updateSeconds < MIN_BENCH_SECONDS) {
+            if (pool.size() == 0) {
+                for (size_t i = 0; i < count; ++i) {
+                    pool.spawn(100.f, 100.f, rng.nextRange(-50.f, 50.f), rng.nextRange(-50.f, 50.f), rng.nextRange(0.4f, 0.8f), 0x00C800);
+                }
+            }
+            updated += static_cast<long long>(pool.size());
+            BenchClock::time_point start = BenchClock::now();
+            pool.update(dt);
+            updateSeconds += secondsSince(start);
+        }
+        double updateNs = updateSeconds * 1e9 / std::max<long long>(updated, 1);
+
+        std::string caseName = std::to_string(count) + " particles";
+        report.add("particles", caseName, "spawn", spawnNs, "ns/particle");
+        report.add("particles", caseName, "spawn burst", burstNs, "ns/particle");
+        report.add("particles", caseName, "update", updateNs, "ns/particle");
+    }
+}
+
+// Cost per random value of the C library, the standard engines and Rng (the per-purpose
+// streams used by the game and the simulations).
+void benchRng(BenchReport& report) {
+    const size_t batch = 4096;
+    std::vector<float> floats(batch);
+
+    std::srand(1);
+    report.add("rng", "u32", "std::rand", measureNs([] { benchSink = static_cast<uint32_t>(std::rand()); }), "ns/value");
+    std::minstd_rand minstd(1);
+    report.add("rng", "u32", "minstd_rand", measureNs([&] { benchSink = static_cast<uint32_t>(minstd()); }), "ns/value");
+    std::mt19937 mt(1);
+    report.add("rng", "u32", "mt19937", measureNs([&] { benchSink = mt(); }), "ns/value");
+    Rng rng(1);
+    report.add("rng", "u32", "Rng", measureNs([&] { benchSink = rng.next(); }), "ns/value");
+    report.add("rng", "below 10000", "Rng", measureNs([&] { benchSink = rng.nextBelow(10000); }), "ns/value");
+
+    report.add("rng", "float range", "rand division", measureNs([] {
+        float value = 50.f + static_cast<float>(std::rand()) / (static_cast<float>(RAND_MAX / 100.f));
+        benchSink = static_cast<uint32_t>(value);
+    }), "ns/value");
+    report.add("rng", "float range", "Rng", measureNs([&] { benchSink = static_cast<uint32_t>(rng.nextRange(50.f, 150.f)); }), "ns/value");
+    double fillNs = measureNs([&] {
+        rng.fillRange(floats.data(), batch, 50.f, 150.f);
+        benchSink = static_cast<uint32_t>(floats[batch - 1]);
+    }) / batch;
+    report.add("rng", "float range", "Rng batch", fillNs, "ns/value");
+}
+
+// Autopilot decisions: a fresh plan every call (worst case) and the amortized cost of playing
+// with path reuse, step() included. Spikes are off so games last.
+void benchAutopilot(BenchReport& report) {
+    const int sizes[][2] = {{DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT}, {100, 100}, {1000, 1000}};
+    for (const auto& size : sizes) {
+        const std::string caseName = boardName(size[0], size[1]);
+        GameSim sim(3, size[0], size[1]);
+        sim.setSpikesEnabled(false);
+        Autopilot autopilot;
+        unsigned seed = 3;
+
+        double planNs = measureNs([&] {
+            autopilot.reset();
+            Direction direction = autopilot.decide(sim);
+            if (sim.step(direction) == StepResult::DIED) sim.reset(++seed);
+        });
+        report.add("autopilot", caseName, "plan+step", planNs / 1000.0, "us/decision");
+
+        sim.reset(++seed);
+        autopilot.reset();
+        uint64_t plansBefore = autopilot.getPlanCount();
+        uint64_t decisionsBefore = autopilot.getDecisionCount();
+        double playNs = measureNs([&] {
+            if (sim.step(autopilot.decide(sim)) == StepResult::DIED) sim.reset(++seed);
+        });
+        double plansPerDecision = static_cast<double>(autopilot.getPlanCount() - plansBefore) /
+                                  static_cast<double>(autopilot.getDecisionCount() - decisionsBefore);
+        report.add("autopilot", caseName, "decide+step", playNs / 1000.0, "us/decision");
+        report.add("autopilot", caseName, "plans", plansPerDecision, "per decision");
+    }
+}
+
+// Hamiltonian solver: building a board's cycle (done once per size, then cached), decisions
+// while playing, and whole games played until the board is full (spikes off).
+void benchHamiltonian(BenchReport& report) {
+    const int sizes[][2] = {{DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT}, {64, 64}, {1000, 1000}};
+    for (const auto& size : sizes) {
+        const std::string caseName = boardName(size[0], size[1]);
+        double buildNs = measureNs([&] {
+            HamiltonianCycle cycle(size[0], size[1]);
+            benchSink = cycle.getCell(cycle.getLength() - 1);
+        });
+        report.add("hamiltonian", caseName, "build cycle", buildNs / 1000.0, "us");
+
+        GameSim sim(3, size[0], size[1]);
+        sim.setSpikesEnabled(false);
+        HamiltonianSolver solver;
+        unsigned seed = 3;
+        double playNs = measureNs([&] {
+            if (sim.step(solver.decide(sim)) == StepResult::DIED) sim.reset(++seed);
+        });
+        report.add("hamiltonian", caseName, "decide+step", playNs, "ns/decision");
+        if (size[0] * size[1] > 64 * 64) continue; // Filling takes too long to time
+
+        sim.reset(++seed);
+        uint64_t ticks = 0;
+        BenchClock::time_point start = BenchClock::now();
+        while (sim.getFood().x >= 0 && sim.step(solver.decide(sim)) != StepResult::DIED) ++ticks;
+        double seconds = secondsSince(start);
+        report.add("hamiltonian", caseName, "fill ticks", static_cast<double>(ticks), "ticks");
+        report.add("hamiltonian", caseName, "fill", seconds * 1000.0, "ms");
+        report.add("hamiltonian", caseName, "filled", sim.getFood().x < 0 ? 1.0 : 0.0, "bool");
+
+        // Same game with shortcuts, which trade the fill guarantee for fewer ticks
+        HamiltonianSolver shortcutSolver;
+        shortcutSolver.setShortcutsEnabled(true);
+        sim.reset(seed);
+        ticks = 0;
+        while (sim.getFood().x >= 0 && sim.step(shortcutSolver.decide(sim)) != StepResult::DIED) ++ticks;
+        report.add("hamiltonian", caseName, "shortcut ticks", static_cast<double>(ticks), "ticks");
+        report.add("hamiltonian", caseName, "shortcut filled", sim.getFood().x < 0 ? 1.0 : 0.0, "bool");
+    }
+}
+
+// libsnake_env C API: one batched step with random actions, without observations and with
+// each observation format, per environment.
+void benchEnv(BenchReport& report) {
+    const uint32_t count = 256;
+    const int sizes[][2] = {{DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT}, {100, 100}};
+    for (const auto& size : sizes) {
+        const std::string caseName = boardName(size[0], size[1]) + " x" + std::to_string(count);
+        SnakeEnv* env = snake_env_create(count, size[0], size[1], 3, SNAKE_ENV_AUTO_RESET, 1);
+        std::vector<uint8_t> observations(static_cast<size_t>(count) * snake_env_observation_size(env));
+        std::vector<int32_t> actions(count);
+        std::vector<float> rewards(count);
+        std::vector<uint8_t> dones(count);
+        Rng rng(3, RngStream::POLICY);
+        snake_env_reset(env, observations.data());
+
+        double stepNs = measureNs([&] {
+            for (int32_t& action : actions) action = static_cast<int32_t>(rng.nextBelow(8)); // Half keep going
+            snake_env_step(env, actions.data(), nullptr, rewards.data(), dones.data());
+        });
+        report.add("env", caseName, "step", stepNs / count, "ns/env");
+        double observedNs = measureNs([&] {
+            for (int32_t& action : actions) action = static_cast<int32_t>(rng.nextBelow(8));
+            snake_env_step(env, actions.data(), observations.data(), rewards.data(), dones.data());
+        });
+        report.add("env", caseName, "step+observation", observedNs / count, "ns/env");
+
+        // Plane formats, updated in place since the buffer is the same every step
+        const struct {
+            uint32_t format;
+            int32_t cropRadius;
+            const char* metric;
+        } planeFormats[] = {{SNAKE_ENV_OBS_CHANNELS, 0, "step+channels"},
+                            {SNAKE_ENV_OBS_BIT_PLANES, 0, "step+bit planes"},
+                            {SNAKE_ENV_OBS_BIT_PLANES, 5, "step+crop 5 bits"}};
+        for (const auto& planes : planeFormats) {
+            snake_env_set_observation(env, planes.format, planes.cropRadius);
+            observations.resize(static_cast<size_t>(count) * snake_env_observation_size(env));
+            snake_env_reset(env, observations.data());
+            double planesNs = measureNs([&] {
+                for (int32_t& action : actions) action = static_cast<int32_t>(rng.nextBelow(8));
+                snake_env_step(env, actions.data(), observations.data(), rewards.data(), dones.data());
+            });
+            report.add("env", caseName, planes.metric, planesNs / count, "ns/env");
+        }
+        snake_env_destroy(env);
+    }
+}
+
+// Arena: one tick of every snake (bot decisions included) on a large board, per snake, for
+// growing snake counts; the cost per snake should stay flat.
+void benchArena(BenchReport& report) {
+    const size_t counts[] = {100, 1000, 10000};
+    for (size_t count : counts) {
+        const std::string caseName = boardName(1000, 1000) + " x" + std::to_string(count);
+        ArenaSim arena(1000, 1000, count, count / 2, 3);
+        std::vector<Direction> directions(count);
+        Rng rng(3, RngStream::POLICY);
+        for (int i = 0; i < 50; ++i) { // Let the snakes spread out and grow a little
+            for (size_t s = 0; s < count; ++s) directions[s] = arena.pickBotDirection(s, rng);
+            arena.step(directions.data());
+        }
+
+        double tickNs = measureNs([&] {
+            for (size_t s = 0; s < count; ++s) directions[s] = arena.pickBotDirection(s, rng);
+            arena.step(directions.data());
+        });
+        report.add("arena", caseName, "bots+step", tickNs / count, "ns/snake");
+        report.add("arena", caseName, "alive", static_cast<double>(arena.getAliveCount()), "snakes");
+    }
+}
+
+// Spectator stream: what a tick costs the game thread, encoding alone and queued for the
+// background writer (to the null device, so the disk is not measured).
+void benchSpectator(BenchReport& report) {
+    GameSim sim(3, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT);
+    sim.setSpikesEnabled(false);
+    HamiltonianSolver solver; // Long games with plenty of food, so every record kind shows up
+    SpectatorEncoder encoder;
+    std::vector<uint8_t> out;
+    unsigned seed = 3;
+    uint64_t bytes = 0;
+    uint64_t ticks = 0;
+    double encodeNs = measureNs([&] {
+        const StepResult result = sim.step(solver.decide(sim));
+        encoder.record(sim, result, out);
+        bytes += out.size();
+        ticks++;
+        out.clear();
+        if (result == StepResult::DIED || sim.getFood().x < 0) {
+            sim.reset(++seed);
+            encoder.begin(sim, out);
+        }
+    });
+    report.add("spectator", boardName(sim.getWidth(), sim.getHeight()), "step+encode", encodeNs, "ns/tick");
+    report.add("spectator", boardName(sim.getWidth(), sim.getHeight()), "stream", double(bytes) / ticks, "bytes/tick");
+
+#if defined(_WIN32)
+    const char* nullDevice = "NUL";
+#else
+    const char* nullDevice = "/dev/null";
+#endif
+    SpectatorWriter writer;
+    writer.start(nullDevice, sim);
+    writer.begin(sim);
+    double queuedNs = measureNs([&] {
+        const StepResult result = sim.step(solver.decide(sim));
+        writer.record(sim, result);
+        if (result == StepResult::DIED || sim.getFood().x < 0) {
+            sim.reset(++seed);
+            writer.begin(sim);
+        }
+    });
+    writer.stop();
+    report.add("spectator", boardName(sim.getWidth(), sim.getHeight()), "step+queue", queuedNs, "ns/tick");
+}
+
+// Save states: copying a game into a slot and loading it back, in memory so the disk is not
+// measured. Both are O(length + moved index slots), a plain copy per array; load also checks
+// the slot before it touches the game.
+void benchSaveState(BenchReport& report) {
+    const int sizes[][2] = {{DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT}, {200, 200}, {1000, 1000}};
+    for (const auto& size : sizes) {
+        const std::string caseName = boardName(size[0], size[1]);
+        GameSim sim(3, size[0], size[1]);
+        sim.setSpikesEnabled(false);
+        HamiltonianSolver solver;
+        for (int i = 0; i < 2000 && sim.isAlive(); ++i) sim.step(solver.decide(sim)); // A body worth copying
+
+        std::vector<uint64_t> slot((getSaveStateSize(sim) + 7) / sizeof(uint64_t));
+        SaveState& state = *reinterpret_cast<SaveState*>(slot.data());
+        double saveNs = measureNs([&] { sim.saveState(state); });
+        GameSim loaded(0, size[0], size[1]);
+        double loadNs = measureNs([&] { benchSink = loaded.loadState(state); });
+        report.add("save_state", caseName, "save", saveNs, "ns/state");
+        report.add("save_state", caseName, "load", loadNs, "ns/state");
+        report.add("save_state", caseName, "size", static_cast<double>(slot.size() * sizeof(uint64_t)), "bytes/state");
+    }
+}
+
+// Every suite main() knows, for --suite
+const char* const SUITES[] = {"spawn", "lockstep", "board_size", "tick_length", "particles", "rng", "autopilot",
+                              "hamiltonian", "env", "arena", "spectator", "save_state",
+#if defined(SNAKE_BENCH_RENDER)
+                              "render",
+#endif
+};
+
+void printUsage() {
+    std::fprintf(stderr, "usage: snake_bench [--format table|csv|json] [--out file] [--suite name]...\nsuites:");
+    for (const char* suite : SUITES) std::fprintf(stderr, " %s", suite);
+    std::fprintf(stderr, "\n");
+}
+
+}
+
+
+int main(int argc, char** argv) {
+    std::string format = "table";
+    std::string outPath;
+    std::vector<std::string> suites;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+        if (arg == "--format") format = argv[++i];
+        else if (arg == "--out") outPath = argv[++i];
+        else if (arg == "--suite") suites.push_back(argv[++i]);
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (format != "table" && format != "csv" && format != "json") {
+        printUsage();
+        return 1;
+    }
+    for (const std::string& suite : suites) {
+        if (std::find(std::begin(SUITES), std::end(SUITES), suite) == std::end(SUITES)) {
+            std::fprintf(stderr, "unknown suite %s\n", suite.c_str());
+            printUsage();
+            return 1;
+        }
+    }
+    auto enabled = [&suites](const char* suite) {
+        return suites.empty() || std::find(suites.begin(), suites.end(), suite) != suites.end();
+    };
+
+    BenchReport report;
+    LockstepSim probe(1);
+    report.setMeta("lockstep_backend", probe.getBackendName());
+#if defined(__VERSION__)
+    report.setMeta("compiler", __VERSION__);
+#endif
+
+    if (enabled("spawn")) benchSpawn(report);
+    if (enabled("lockstep")) benchLockstep(report);
+    if (enabled("board_size")) benchBoardSize(report);
+    if (enabled("tick_length")) benchTickByLength(report);
+    if (enabled("particles")) benchParticles(report);
+    if (enabled("rng")) benchRng(report);
+    if (enabled("autopilot")) benchAutopilot(report);
+    if (enabled("hamiltonian")) benchHamiltonian(report);
+    if (enabled("env")) benchEnv(report);
+    if (enabled("arena")) benchArena(report);
+    if (enabled("spectator")) benchSpectator(report);
+    if (enabled("save_state")) benchSaveState(report);
+#if defined(SNAKE_BENCH_RENDER)
+    if (enabled("render")) benchRender(report);
+#endif
+
+    FILE* out = stdout;
+    if (!outPath.empty()) {
+        out = std::fopen(outPath.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "cannot write %s\n", outPath.c_str());
+            return 1;
+        }
+    }
+    if (format == "csv") report.writeCsv(out);
+    else if (format == "json") report.writeJson(out);
+    else report.writeTable(out);
+    if (out != stdout) std::fclose(out);
+    return 0;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+
+// Packed occupancy grid, one bit per cell (row-major, cell = y * width + x).
+class Bitboard {
+public:
+    Bitboard() : m_width(0), m_height(0) {}
+    Bitboard(int width, int height) { resize(width, height); }
+
+    void resize(int width, int height) {
+        m_width = width;
+        m_height = height;
+        m_words.assign((static_cast<size_t>(width) * height + 63) / 64, 0);
+    }
+
+    void clear() { std::fill(m_words.begin(), m_words.end(), 0); }
+
+    bool test(int x, int y) const { return testCell(cellIndex(x, y)); }
+    void set(int x, int y) { setCell(cellIndex(x, y)); }
+    void reset(int x, int y) { resetCell(cellIndex(x, y)); }
+
+    bool testCell(size_t cell) const { return (m_words[cell >> 6] >> (cell & 63)) & 1u; }
+    void setCell(size_t cell) { m_words[cell >> 6] |= uint64_t(1) << (cell & 63); }
+    void resetCell(size_t cell) { m_words[cell >> 6] &= ~(uint64_t(1) << (cell & 63)); }
+
+    // count (up to 64) bits from cell on, bit i for cell + i; cells past the end read as 0.
+    uint64_t getBits(size_t cell, int count) const {
+        const size_t word = cell >> 6;
+        const unsigned shift = cell & 63;
+        uint64_t bits = m_words[word] >> shift;
+        if (shift != 0 && word + 1 < m_words.size()) bits |= m_words[word + 1] << (64 - shift);
+        return count < 64 ? bits & ((uint64_t(1) << count) - 1) : bits;
+    }
+
+    size_t cellIndex(int x, int y) const { return static_cast<size_t>(y) * m_width + x; }
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+
+    const std::vector<uint64_t>& getWords() const { return m_words; }
+
+private:
+    int m_width;
+    int m_height;
+    std::vector<uint64_t> m_words;
+};
@@ -0,0 +1,181 @@
+#include "board_texture.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace {
+
+const sf::Color HEAD_COLOR(0, 255, 0);
+const sf::Color BODY_COLOR(0, 200, 0);
+const sf::Color FOOD_COLOR(255, 0, 0);
+const sf::Color SPIKE_COLOR(255, 255, 0);
+const sf::Color EMPTY_COLOR(0, 0, 0, 0);  // Lets the window clear color show through
+const sf::Color GRID_COLOR(50, 50, 50);
+const float MIN_GRID_BLOCK_SIZE = 4.f;
+
+sf::Color cellColor(const GameSim& sim, int x, int y) {
+    Point head = sim.getSnake().front();
+    if (head.x == x && head.y == y) return HEAD_COLOR;
+    if (sim.getOccupancy().test(x, y)) return BODY_COLOR;
+    Point food = sim.getFood();
+    if (food.x == x && food.y == y) return FOOD_COLOR;
+    if (x < sim.getLeftSpikeWall() || x >= sim.getRightSpikeWall() ||
+        y < sim.getTopSpikeWall() || y >= sim.getBottomSpikeWall()) return SPIKE_COLOR;
+    return EMPTY_COLOR;
+}
+
+void setQuad(sf::Vertex* quad, float width, float height, float texWidth, float texHeight) {
+    quad[0] = sf::Vertex(sf::Vector2f(0.f, 0.f), sf::Vector2f(0.f, 0.f));
+    quad[1] = sf::Vertex(sf::Vector2f(width, 0.f), sf::Vector2f(texWidth, 0.f));
+    quad[2] = sf::Vertex(sf::Vector2f(width, height), sf::Vector2f(texWidth, texHeight));
+    quad[3] = sf::Vertex(sf::Vector2f(0.f, height), sf::Vector2f(0.f, texHeight));
+}
+
+}
+
+
+BoardTexture::BoardTexture(float blockSize)
+    : m_blockSize(blockSize), m_width(0), m_height(0), m_showGrid(false),
+      m_head{-1, -1}, m_tail{-1, -1}, m_food{-1, -1}, m_left(0), m_right(0), m_top(0), m_bottom(0) {
+}
+
+void BoardTexture::setBlockSize(float blockSize) {
+    m_blockSize = blockSize;
+}
+
+bool BoardTexture::reset(const GameSim& sim) {
+    if (sim.getWidth() != m_width || sim.getHeight() != m_height) {
+        unsigned maxSize = sf::Texture::getMaximumSize();
+        if (static_cast<unsigned>(sim.getWidth()) > maxSize || static_cast<unsigned>(sim.getHeight()) > maxSize) return false;
+        if (!m_texture.create(sim.getWidth(), sim.getHeight())) return false;
+        m_texture.setSmooth(false); // Hard cell edges when scaled up
+        m_width = sim.getWidth();
+        m_height = sim.getHeight();
+        m_pixels.assign(static_cast<size_t>(m_width) * m_height * 4, 0);
+        m_scratch.resize(static_cast<size_t>(m_height) * 4);
+    }
+
+    setQuad(m_boardQuad, m_width * m_blockSize, m_height * m_blockSize, static_cast<float>(m_width), static_cast<float>(m_height));
+    buildGridTile();
+
+    repaintRows(sim, 0, m_height);
+    m_head = sim.getSnake().front();
+    m_tail = sim.getSnake().back();
+    m_food = sim.getFood();
+    m_left = sim.getLeftSpikeWall();
+    m_right = sim.getRightSpikeWall();
+    m_top = sim.getTopSpikeWall();
+    m_bottom = sim.getBottomSpikeWall();
+    return true;
+}
+
+void BoardTexture::buildGridTile() {
+    m_showGrid = m_blockSize >= MIN_GRID_BLOCK_SIZE;
+    if (!m_showGrid) return;
+
+    // One cell with its top and left edge drawn; repeating it over the board gives the grid
+    unsigned tile = static_cast<unsigned>(std::lround(m_blockSize));
+    sf::Image image;
+    image.create(tile, tile, EMPTY_COLOR);
+    for (unsigned i = 0; i < tile; ++i) {
+        image.setPixel(i, 0, GRID_COLOR);
+        image.setPixel(0, i, GRID_COLOR);
+    }
+    if (!m_gridTile.create(tile, tile)) {
+        m_showGrid = false;
+        return;
+    }
+    m_gridTile.update(image);
+    m_gridTile.setRepeated(true);
+    setQuad(m_gridQuad, m_width * m_blockSize, m_height * m_blockSize, static_cast<float>(m_width * tile),
+            static_cast<float>(m_height * tile));
+}
+
+void BoardTexture::update(const GameSim& sim) {
+    // Spike walls: repaint only the band each wall moved over (one row or column per advance,
+    // the whole retreat when food is eaten)
+    int top = sim.getTopSpikeWall();
+    int bottom = sim.getBottomSpikeWall();
+    int left = sim.getLeftSpikeWall();
+    int right = sim.getRightSpikeWall();
+    if (top != m_top) repaintRows(sim, std::min(top, m_top), std::max(top, m_top));
+    if (bottom != m_bottom) repaintRows(sim, std::min(bottom, m_bottom), std::max(bottom, m_bottom));
+    if (left != m_left) repaintColumns(sim, std::min(left, m_left), std::max(left, m_left));
+    if (right != m_right) repaintColumns(sim, std::min(right, m_right), std::max(right, m_right));
+    m_top = top;
+    m_bottom = bottom;
+    m_left = left;
+    m_right = right;
+
+    // Cells that may have changed this tick; painting looks the state up, so order is irrelevant
+    Point head = sim.getSnake().front();
+    Point tail = sim.getSnake().back();
+    Point food = sim.getFood();
+    const Point touched[] = {m_head, m_tail, m_food, head, tail, food};
+    for (const Point& cell : touched) {
+        if (cell.x >= 0) paintCell(sim, cell.x, cell.y);
+    }
+    m_head = head;
+    m_tail = tail;
+    m_food = food;
+}
+
+void BoardTexture::paintCell(const GameSim& sim, int x, int y) {
+    sf::Color color = cellColor(sim, x, y);
+    sf::Uint8* texel = &m_pixels[(static_cast<size_t>(y) * m_width + x) * 4];
+    if (texel[0] == color.r && texel[1] == color.g && texel[2] == color.b && texel[3] == color.a) return;
+    texel[0] = color.r;
+    texel[1] = color.g;
+    texel[2] = color.b;
+    texel[3] = color.a;
+    uploadCell(x, y);
+}
+
+void BoardTexture::uploadCell(int x, int y) {
+    m_texture.update(&m_pixels[(static_cast<size_t>(y) * m_width + x) * 4], 1, 1, x, y);
+}
+
+void BoardTexture::repaintRows(const GameSim& sim, int firstRow, int endRow) {
+    firstRow = std::max(firstRow, 0);
+    endRow = std::min(endRow, m_height);
+    if (firstRow >= endRow) return;
+    for (int y = firstRow; y < endRow; ++y) {
+        sf::Uint8* texel = &m_pixels[static_cast<size_t>(y) * m_width * 4];
+        for (int x = 0; x < m_width; ++x, texel += 4) {
+            sf::Color color = cellColor(sim, x, y);
+            texel[0] = color.r;
+            texel[1] = color.g;
+            texel[2] = color.b;
+            texel[3] = color.a;
+        }
+    }
+    // Whole rows are contiguous in m_pixels, so the band goes up in one call
+    m_texture.update(&m_pixels[static_cast<size_t>(firstRow) * m_width * 4], m_width, endRow - firstRow, 0, firstRow);
+}
+
+void BoardTexture::repaintColumns(const GameSim& sim, int firstColumn, int endColumn) {
+    firstColumn = std::max(firstColumn, 0);
+    endColumn = std::min(endColumn, m_width);
+    for (int x = firstColumn; x < endColumn; ++x) {
+        for (int y = 0; y < m_height; ++y) {
+            sf::Color color = cellColor(sim, x, y);
+            sf::Uint8* texel = &m_pixels[(static_cast<size_t>(y) * m_width + x) * 4];
+            texel[0] = m_scratch[y * 4 + 0] = color.r;
+            texel[1] = m_scratch[y * 4 + 1] = color.g;
+            texel[2] = m_scratch[y * 4 + 2] = color.b;
+            texel[3] = m_scratch[y * 4 + 3] = color.a;
+        }
+        m_texture.update(m_scratch.data(), 1, m_height, x, 0);
+    }
+}
+
+void BoardTexture::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    if (m_width == 0) return;
+    states.texture = &m_texture;
+    target.draw(m_boardQuad, 4, sf::Quads, states);
+    if (m_showGrid) {
+        states.texture = &m_gridTile;
+        target.draw(m_gridQuad, 4, sf::Quads, states);
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "game_sim.h"
+
+
+// Whole board as a width x height texture, one texel per cell, drawn as a single scaled quad
+// with an optional repeated grid tile on top. After reset() only the cells that changed in a
+// tick (old/new head, old tail, old/new food and the band the spike walls moved over) are
+// re-uploaded, so the frame cost depends on neither the snake length nor the board area.
+class BoardTexture : public sf::Drawable {
+public:
+    explicit BoardTexture(float blockSize);
+
+    void setBlockSize(float blockSize);
+
+    // Uploads the full board; false if the board exceeds the GPU texture size limit.
+    bool reset(const GameSim& sim);
+
+    // Call after every GameSim::step() to bring the texels in line with sim.
+    void update(const GameSim& sim);
+
+    // Draw calls one draw() issues: the board quad, plus the grid quad when shown.
+    unsigned getDrawCallCount() const { return m_width == 0 ? 0 : (m_showGrid ? 2 : 1); }
+
+private:
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+    void buildGridTile();
+    void paintCell(const GameSim& sim, int x, int y);
+    void uploadCell(int x, int y);
+    void repaintRows(const GameSim& sim, int firstRow, int endRow);
+    void repaintColumns(const GameSim& sim, int firstColumn, int endColumn);
+
+    float m_blockSize;
+    int m_width;
+    int m_height;
+    sf::Texture m_texture;
+    sf::Texture m_gridTile;
+    bool m_showGrid;
+    std::vector<sf::Uint8> m_pixels;   // CPU copy of the texture, RGBA per cell
+    std::vector<sf::Uint8> m_scratch;  // Column uploads are gathered here
+    sf::Vertex m_boardQuad[4];
+    sf::Vertex m_gridQuad[4];
+
+    // State the texels currently show
+    Point m_head;
+    Point m_tail;
+    Point m_food;
+    int m_left;
+    int m_right;
+    int m_top;
+    int m_bottom;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+// Little-endian writer for the binary formats (replays, streams, save states).
+class ByteWriter {
+public:
+    explicit ByteWriter(std::vector<uint8_t>& out) : m_out(out) {}
+
+    void putU8(uint8_t v) { m_out.push_back(v); }
+    void putU16(uint16_t v) { putLittleEndian(v, 2); }
+    void putU32(uint32_t v) { putLittleEndian(v, 4); }
+    void putU64(uint64_t v) { putLittleEndian(v, 8); }
+
+    // LEB128: 7 bits per byte, high bit set on all but the last byte
+    void putVarint(uint64_t v) {
+        while (v >= 0x80) {
+            m_out.push_back(static_cast<uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        m_out.push_back(static_cast<uint8_t>(v));
+    }
+
+    void putBytes(const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; ++i) m_out.push_back(bytes[i]);
+    }
+
+private:
+    void putLittleEndian(uint64_t v, int bytes) {
+        for (int i = 0; i < bytes; ++i) m_out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    std::vector<uint8_t>& m_out;
+};
+
+
+// Bounds-checked reader matching ByteWriter. Every getter returns false once the input is
+// exhausted or malformed and leaves the reader failed.
+class ByteReader {
+public:
+    ByteReader(const uint8_t* data, size_t size) : m_data(data), m_size(size), m_pos(0), m_failed(false) {}
+
+    bool getU8(uint8_t& v) { uint64_t x; if (!getLittleEndian(x, 1)) return false; v = static_cast<uint8_t>(x); return true; }
+    bool getU16(uint16_t& v) { uint64_t x; if (!getLittleEndian(x, 2)) return false; v = static_cast<uint16_t>(x); return true; }
+    bool getU32(uint32_t& v) { uint64_t x; if (!getLittleEndian(x, 4)) return false; v = static_cast<uint32_t>(x); return true; }
+    bool getU64(uint64_t& v) { return getLittleEndian(v, 8); }
+
+    bool getVarint(uint64_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte;
+            if (!getU8(byte)) return false;
+            v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        m_failed = true;
+        return false;
+    }
+
+    size_t getPosition() const { return m_pos; }
+    size_t getRemaining() const { return m_size - m_pos; }
+    bool hasFailed() const { return m_failed; }
+
+private:
+    bool getLittleEndian(uint64_t& v, int bytes) {
+        if (m_failed || m_size - m_pos < static_cast<size_t>(bytes)) {
+            m_failed = true;
+            return false;
+        }
+        v = 0;
+        for (int i = 0; i < bytes; ++i) v |= static_cast<uint64_t>(m_data[m_pos + i]) << (8 * i);
+        m_pos += bytes;
+        return true;
+    }
+
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_pos;
+    bool m_failed;
+};
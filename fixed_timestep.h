@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+
+
+// Fixed-timestep tick scheduler working in integer microseconds.
+// Each frame feed the elapsed real time to beginFrame(), then run one simulation tick per
+// successful consumeTick(). The tick interval may change between ticks (the snake speeds up
+// when it eats), so it is passed on every call instead of being fixed at construction.
+// At most maxTicksPerFrame ticks run per frame; time beyond that is dropped so a long stall
+// cannot snowball into ever longer catch-up frames.
+class FixedTimestep {
+public:
+    explicit FixedTimestep(int maxTicksPerFrame = 8)
+        : m_maxTicksPerFrame(maxTicksPerFrame), m_accumulator(0), m_ticksThisFrame(0), m_tickCount(0), m_droppedMicros(0) {}
+
+    // Starts over with the given amount of time already pending (pass the tick interval to
+    // run the first tick immediately).
+    void reset(int64_t pendingMicros = 0) {
+        m_accumulator = pendingMicros;
+        m_ticksThisFrame = 0;
+        m_tickCount = 0;
+        m_droppedMicros = 0;
+    }
+
+    void beginFrame(int64_t elapsedMicros) {
+        if (elapsedMicros > 0) m_accumulator += elapsedMicros;
+        m_ticksThisFrame = 0;
+    }
+
+    // True when a tick of tickMicros is due; the caller must then run exactly one tick.
+    bool consumeTick(int64_t tickMicros) {
+        if (m_accumulator < tickMicros) return false;
+        if (m_ticksThisFrame >= m_maxTicksPerFrame) {
+            // Over budget: keep the phase within the current tick, drop whole ticks of backlog
+            int64_t kept = m_accumulator % tickMicros;
+            m_droppedMicros += m_accumulator - kept;
+            m_accumulator = kept;
+            return false;
+        }
+        m_accumulator -= tickMicros;
+        ++m_ticksThisFrame;
+        ++m_tickCount;
+        return true;
+    }
+
+    // Progress towards the next tick in [0, 1), for interpolating between the last two states.
+    float getAlpha(int64_t tickMicros) const {
+        if (tickMicros <= 0 || m_accumulator <= 0) return 0.f;
+        if (m_accumulator >= tickMicros) return 1.f;
+        return static_cast<float>(m_accumulator) / static_cast<float>(tickMicros);
+    }
+
+    void setMaxTicksPerFrame(int maxTicks) { m_maxTicksPerFrame = maxTicks; }
+    int getMaxTicksPerFrame() const { return m_maxTicksPerFrame; }
+    int getTicksThisFrame() const { return m_ticksThisFrame; }
+    uint64_t getTickCount() const { return m_tickCount; }
+    int64_t getDroppedMicros() const { return m_droppedMicros; } // Backlog discarded by the cap
+
+private:
+    int m_maxTicksPerFrame;
+    int64_t m_accumulator;
+    int m_ticksThisFrame;
+    uint64_t m_tickCount;
+    int64_t m_droppedMicros;
+};
@@ -0,0 +1,82 @@
+#include "frame_profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+const char* getFramePhaseName(FramePhase phase) {
+    switch (phase) {
+        case FramePhase::EVENTS:  return "events";
+        case FramePhase::UPDATE:  return "update";
+        case FramePhase::DRAW:    return "draw";
+        case FramePhase::DISPLAY: return "display";
+        case FramePhase::COUNT:   break;
+    }
+    return "?";
+}
+
+
+FrameProfiler::FrameProfiler(size_t historySize)
+    : m_currentPhaseMs(),
+      m_frameMs(std::max<size_t>(historySize, 1), 0.f),
+      m_phaseMs(std::max<size_t>(historySize, 1) * PHASE_COUNT, 0.f),
+      m_next(0),
+      m_frameCount(0),
+      m_drawCalls(0),
+      m_lastDrawCalls(0) {
+    m_frameStart = m_lastMark = Clock::now();
+}
+
+void FrameProfiler::beginFrame() {
+    m_frameStart = m_lastMark = Clock::now();
+    std::fill(m_currentPhaseMs, m_currentPhaseMs + PHASE_COUNT, 0.f);
+    m_drawCalls = 0;
+}
+
+void FrameProfiler::endPhase(FramePhase phase) {
+    Clock::time_point now = Clock::now();
+    m_currentPhaseMs[static_cast<size_t>(phase)] += std::chrono::duration<float, std::milli>(now - m_lastMark).count();
+    m_lastMark = now;
+}
+
+void FrameProfiler::endFrame() {
+    m_frameMs[m_next] = std::chrono::duration<float, std::milli>(Clock::now() - m_frameStart).count();
+    std::copy(m_currentPhaseMs, m_currentPhaseMs + PHASE_COUNT, m_phaseMs.begin() + m_next * PHASE_COUNT);
+    m_next = (m_next + 1) % m_frameMs.size();
+    m_frameCount++;
+    m_lastDrawCalls = m_drawCalls;
+}
+
+float FrameProfiler::getFrameMs(size_t i) const {
+    size_t count = getHistorySize();
+    size_t oldest = (m_next + m_frameMs.size() - count) % m_frameMs.size();
+    return m_frameMs[(oldest + i) % m_frameMs.size()];
+}
+
+FrameStats FrameProfiler::computeStats() const {
+    FrameStats stats = {};
+    stats.drawCalls = m_lastDrawCalls;
+    stats.frames = getHistorySize();
+    if (stats.frames == 0) return stats;
+
+    m_sortScratch.resize(stats.frames);
+    for (size_t i = 0; i < stats.frames; ++i) m_sortScratch[i] = getFrameMs(i);
+    auto percentile = [this](double fraction) {
+        size_t rank = static_cast<size_t>(std::ceil(fraction * m_sortScratch.size()));
+        rank = std::min(std::max<size_t>(rank, 1), m_sortScratch.size()) - 1;
+        std::nth_element(m_sortScratch.begin(), m_sortScratch.begin() + rank, m_sortScratch.end());
+        return static_cast<double>(m_sortScratch[rank]);
+    };
+    stats.p50Ms = percentile(0.50);
+    stats.p99Ms = percentile(0.99);
+    stats.maxMs = *std::max_element(m_sortScratch.begin(), m_sortScratch.end());
+
+    // The filled part of the ring is the same set of frames whichever way round it is read
+    for (size_t i = 0; i < stats.frames; ++i) {
+        for (size_t phase = 0; phase < PHASE_COUNT; ++phase) {
+            stats.phaseAverageMs[phase] += m_phaseMs[i * PHASE_COUNT + phase];
+        }
+    }
+    for (double& average : stats.phaseAverageMs) average /= stats.frames;
+    return stats;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+enum class FramePhase { EVENTS, UPDATE, DRAW, DISPLAY, COUNT };
+
+const char* getFramePhaseName(FramePhase phase);
+
+struct FrameStats {
+    size_t frames;                                          // Frames in the history window
+    double p50Ms;
+    double p99Ms;
+    double maxMs;
+    double phaseAverageMs[static_cast<size_t>(FramePhase::COUNT)];
+    unsigned drawCalls;                                     // Of the last finished frame
+};
+
+
+// Cheap always-on frame timer: one steady_clock read per phase boundary and a fixed-size
+// ring of the last historySize frames. Percentiles are only computed on request.
+//   beginFrame(); ...events...; endPhase(EVENTS); ...update...; endPhase(UPDATE); ...; endFrame();
+class FrameProfiler {
+public:
+    explicit FrameProfiler(size_t historySize = 240);
+
+    void beginFrame();
+    void endPhase(FramePhase phase);   // Charges the time since the previous mark to phase
+    void endFrame();
+
+    void countDrawCall(unsigned calls = 1) { m_drawCalls += calls; }
+
+    FrameStats computeStats() const;
+
+    // Frame times in milliseconds, oldest first, for graphs.
+    size_t getHistorySize() const { return m_frameCount < m_frameMs.size() ? m_frameCount : m_frameMs.size(); }
+    float getFrameMs(size_t i) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static const size_t PHASE_COUNT = static_cast<size_t>(FramePhase::COUNT);
+
+    Clock::time_point m_frameStart;
+    Clock::time_point m_lastMark;
+    float m_currentPhaseMs[PHASE_COUNT];
+
+    std::vector<float> m_frameMs;   // Ring buffers of historySize entries
+    std::vector<float> m_phaseMs;   // PHASE_COUNT entries per frame
+    size_t m_next;
+    size_t m_frameCount;
+
+    unsigned m_drawCalls;
+    unsigned m_lastDrawCalls;
+    mutable std::vector<float> m_sortScratch;
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "rng.h"
+
+
+// A slot of FreeCellIndex and the cell it holds, see exportOrder()
+struct FreeCellSlot {
+    uint32_t slot;
+    uint32_t cell;
+};
+
+// Set of free board cells supporting O(1) occupy/release and uniform sampling.
+// m_cells is a permutation of all cells where the first m_freeCount entries are free;
+// m_position maps a cell back to its slot so occupy/release are a single swap.
+// Entries whose stamp is older than m_generation read as the identity, which lets clear()
+// restore the initial order in O(1) even on very large boards. Every value is stored next to
+// its stamp, so a swap touches four cache lines at most. The slots stamped since the last
+// clear() are listed too, so the order can be saved in O(slots touched) instead of O(cells).
+class FreeCellIndex {
+public:
+    FreeCellIndex() : m_freeCount(0), m_generation(1) {}
+    explicit FreeCellIndex(size_t cellCount) : m_freeCount(0), m_generation(1) { resize(cellCount); }
+
+    // Allocates for cellCount cells and clears. O(cellCount).
+    void resize(size_t cellCount) {
+        m_cells.assign(cellCount, Entry{0, 0});
+        m_position.assign(cellCount, Entry{0, 0});
+        m_touched.clear();
+        m_touched.reserve(cellCount);
+        m_generation = 1;
+        m_freeCount = cellCount;
+    }
+
+    // Marks every cell free and restores the identity order, so sampling afterwards only
+    // depends on later operations. O(1) apart from a full wipe every 2^32 clears.
+    void clear() {
+        if (++m_generation == 0) {
+            for (Entry& entry : m_cells) entry.stamp = 0;
+            for (Entry& entry : m_position) entry.stamp = 0;
+            m_generation = 1;
+        }
+        m_touched.clear();
+        m_freeCount = m_cells.size();
+    }
+
+    bool isFree(uint32_t cell) const { return positionOf(cell) < m_freeCount; }
+    size_t getFreeCount() const { return m_freeCount; }
+    size_t getCellCount() const { return m_cells.size(); }
+
+    void occupy(uint32_t cell) {
+        if (!isFree(cell)) return;
+        swapSlots(positionOf(cell), static_cast<uint32_t>(--m_freeCount));
+    }
+
+    void release(uint32_t cell) {
+        if (isFree(cell)) return;
+        swapSlots(positionOf(cell), static_cast<uint32_t>(m_freeCount++));
+    }
+
+    // Slots that may no longer hold their own cell: every other slot s still holds cell s.
+    size_t getOrderSize() const { return m_touched.size(); }
+
+    // Writes the getOrderSize() slots above with their cells.
+    void exportOrder(FreeCellSlot* out) const {
+        for (size_t i = 0; i < m_touched.size(); ++i) out[i] = FreeCellSlot{m_touched[i], cellAt(m_touched[i])};
+    }
+
+    // Restores an order written by exportOrder() whose first freeCount slots are free, so later
+    // sampling matches the index it came from. O(count). The slots have to be distinct and hold
+    // exactly the same set of cells (isValidOrder()), or the index breaks.
+    void importOrder(const FreeCellSlot* order, size_t count, size_t freeCount) {
+        clear();
+        for (size_t i = 0; i < count; ++i) {
+            m_cells[order[i].slot] = Entry{order[i].cell, m_generation};
+            m_position[order[i].cell] = Entry{order[i].slot, m_generation};
+            m_touched.push_back(order[i].slot);
+        }
+        m_freeCount = freeCount;
+    }
+
+    // Whether order[0..count) is a valid argument for importOrder() on cellCount cells.
+    // byCell receives the entries sorted by cell, for looking up positions. O(count log count).
+    static bool isValidOrder(const FreeCellSlot* order, size_t count, size_t cellCount,
+                             std::vector<FreeCellSlot>& byCell) {
+        std::vector<FreeCellSlot> bySlot(order, order + count);
+        byCell.assign(order, order + count);
+        std::sort(bySlot.begin(), bySlot.end(), [](FreeCellSlot a, FreeCellSlot b) { return a.slot < b.slot; });
+        std::sort(byCell.begin(), byCell.end(), [](FreeCellSlot a, FreeCellSlot b) { return a.cell < b.cell; });
+        for (size_t i = 0; i < count; ++i) {
+            // Distinct slots, distinct cells, and both the same set
+            if (bySlot[i].slot >= cellCount || bySlot[i].slot != byCell[i].cell ||
+                (i > 0 && bySlot[i].slot == bySlot[i - 1].slot)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Uniformly random free cell; the index must not be empty.
+    uint32_t sample(Rng& rng) const {
+        return cellAt(rng.nextBelow(static_cast<uint32_t>(m_freeCount)));
+    }
+
+private:
+    struct Entry {
+        uint32_t value;
+        uint32_t stamp; // Value is valid when equal to m_generation
+    };
+
+    uint32_t cellAt(uint32_t slot) const { return m_cells[slot].stamp == m_generation ? m_cells[slot].value : slot; }
+    uint32_t positionOf(uint32_t cell) const {
+        return m_position[cell].stamp == m_generation ? m_position[cell].value : cell;
+    }
+
+    void swapSlots(uint32_t a, uint32_t b) {
+        if (m_cells[a].stamp != m_generation) m_touched.push_back(a);
+        if (b != a && m_cells[b].stamp != m_generation) m_touched.push_back(b);
+        uint32_t cellA = cellAt(a);
+        uint32_t cellB = cellAt(b);
+        m_cells[a] = Entry{cellB, m_generation};
+        m_cells[b] = Entry{cellA, m_generation};
+        m_position[cellB] = Entry{a, m_generation};
+        m_position[cellA] = Entry{b, m_generation};
+    }
+
+    std::vector<Entry> m_cells;
+    std::vector<Entry> m_position;
+    std::vector<uint32_t> m_touched; // Slots stamped with m_generation, capacity for every cell
+    size_t m_freeCount;
+    uint32_t m_generation;
+};
@@ -0,0 +1,263 @@
+#include "game_sim.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "save_state.h"
+
+
+bool isOppositeDirection(Direction a, Direction b) {
+    return (a == Direction::UP && b == Direction::DOWN) || (a == Direction::DOWN && b == Direction::UP) ||
+           (a == Direction::LEFT && b == Direction::RIGHT) || (a == Direction::RIGHT && b == Direction::LEFT);
+}
+
+
+GameSim::GameSim(unsigned seed, int width, int height)
+    : m_width(width),
+      m_height(height),
+      m_snake(static_cast<size_t>(width) * height),
+      m_occupied(width, height),
+      m_freeCells(static_cast<size_t>(width) * height),
+      m_spikesEnabled(true) {
+    reset(seed);
+}
+
+void GameSim::reset(unsigned seed) {
+    m_seed = seed;
+    m_rng.seed(seed, RngStream::FOOD);
+    // Only the old body is set in the bitboard, so clearing it costs the snake length.
+    // The index is restored to its initial order: sampling depends on its permutation, and
+    // the same seed has to give the same game no matter what was played before
+    for (const Point& segment : m_snake) {
+        m_occupied.reset(segment.x, segment.y);
+    }
+    m_freeCells.clear();
+    m_snake.clear();
+    m_snake.push_front({m_width / 2, m_height / 2});
+    occupyCell(m_snake.front());
+    m_direction = Direction::NONE;
+    m_tickMicros = INITIAL_TICK_MICROS;
+    m_score = 0;
+    m_alive = true;
+    spawnFood();
+}
+
+void GameSim::resetSpikeWalls() {
+    m_foodTimer = 0;
+    m_spikeAdvanceTimer = 0;
+    m_leftSpikeWall = 0;
+    m_rightSpikeWall = m_width;
+    m_topSpikeWall = 0;
+    m_bottomSpikeWall = m_height;
+}
+
+void GameSim::advanceSpikeWalls(int32_t dtMicros) {
+    // Saturate so a snake idling near the food for a very long time cannot overflow the timer
+    if (m_foodTimer < SPIKE_TIMER_MICROS) m_foodTimer += dtMicros;
+    if (m_foodTimer < SPIKE_TIMER_MICROS) return; // Start advancing spikes if food isn't eaten
+
+    m_spikeAdvanceTimer += dtMicros;
+    if (m_spikeAdvanceTimer >= SPIKE_ADVANCE_INTERVAL_MICROS) {
+        m_spikeAdvanceTimer -= SPIKE_ADVANCE_INTERVAL_MICROS;
+
+        // Advance walls, ensuring they don't cross
+        if (m_leftSpikeWall < m_rightSpikeWall - 1) m_leftSpikeWall++;
+        if (m_rightSpikeWall > m_leftSpikeWall + 1) m_rightSpikeWall--;
+        if (m_topSpikeWall < m_bottomSpikeWall - 1) m_topSpikeWall++;
+        if (m_bottomSpikeWall > m_topSpikeWall + 1) m_bottomSpikeWall--;
+    }
+}
+
+void GameSim::occupyCell(Point p) {
+    m_occupied.set(p.x, p.y);
+    m_freeCells.occupy(static_cast<uint32_t>(m_occupied.cellIndex(p.x, p.y)));
+}
+
+void GameSim::releaseCell(Point p) {
+    m_occupied.reset(p.x, p.y);
+    m_freeCells.release(static_cast<uint32_t>(m_occupied.cellIndex(p.x, p.y)));
+}
+
+void GameSim::spawnFood() {
+    if (m_freeCells.getFreeCount() == 0) {
+        m_food = {-1, -1}; // Board is full, nothing left to eat
+    } else {
+        uint32_t cell = m_freeCells.sample(m_rng);
+        m_food = {static_cast<int>(cell % m_width), static_cast<int>(cell / m_width)};
+    }
+    resetSpikeWalls();
+}
+
+StepResult GameSim::step(Direction requested) {
+    if (!m_alive) return StepResult::IDLE;
+
+    if (requested != Direction::NONE && !isOppositeDirection(requested, m_direction)) {
+        m_direction = requested;
+    }
+    if (m_direction == Direction::NONE) return StepResult::IDLE; // Waiting for the first move
+
+    if (m_spikesEnabled) advanceSpikeWalls(m_tickMicros);
+
+    Point newHead = m_snake.front();
+    switch (m_direction) {
+        case Direction::UP:    newHead.y--; break;
+        case Direction::DOWN:  newHead.y++; break;
+        case Direction::LEFT:  newHead.x--; break;
+        case Direction::RIGHT: newHead.x++; break;
+        case Direction::NONE: break;
+    }
+
+    // The tail is still occupied here: moving into the cell the tail is leaving counts as a hit
+    bool collision = newHead.x < 0 || newHead.x >= m_width || newHead.y < 0 || newHead.y >= m_height ||
+                     newHead.x < m_leftSpikeWall || newHead.x >= m_rightSpikeWall ||
+                     newHead.y < m_topSpikeWall || newHead.y >= m_bottomSpikeWall ||
+                     m_occupied.test(newHead.x, newHead.y);
+
+    if (collision) {
+        m_alive = false;
+        return StepResult::DIED;
+    }
+
+    m_snake.push_front(newHead);
+    occupyCell(newHead);
+    if (newHead == m_food) {
+        m_score++;
+        spawnFood();
+        if (m_tickMicros > MIN_TICK_MICROS) {
+            m_tickMicros -= TICK_MICROS_DECREMENT;
+        }
+        return StepResult::ATE;
+    }
+    releaseCell(m_snake.back());
+    m_snake.pop_back();
+    return StepResult::MOVED;
+}
+
+uint64_t GameSim::computeStateHash() const {
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&hash](uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            hash ^= (value >> (8 * i)) & 0xFF;
+            hash *= 1099511628211ull;
+        }
+    };
+
+    mix(static_cast<uint32_t>(m_snake.size()));
+    for (const Point& segment : m_snake) {
+        mix(static_cast<uint32_t>(segment.x));
+        mix(static_cast<uint32_t>(segment.y));
+    }
+    mix(static_cast<uint32_t>(m_food.x));
+    mix(static_cast<uint32_t>(m_food.y));
+    mix(static_cast<uint32_t>(m_direction));
+    mix(static_cast<uint32_t>(m_score));
+    mix(m_alive ? 1u : 0u);
+    if (!m_spikesEnabled) mix(0x5350494Bu); // Only when off, so hashes of classic games are unchanged
+    mix(static_cast<uint32_t>(m_tickMicros));
+    mix(static_cast<uint32_t>(m_foodTimer));
+    mix(static_cast<uint32_t>(m_spikeAdvanceTimer));
+    mix(static_cast<uint32_t>(m_leftSpikeWall));
+    mix(static_cast<uint32_t>(m_rightSpikeWall));
+    mix(static_cast<uint32_t>(m_topSpikeWall));
+    mix(static_cast<uint32_t>(m_bottomSpikeWall));
+    return hash;
+}
+
+void GameSim::saveState(SaveState& state) const {
+    state.width = m_width;
+    state.height = m_height;
+    state.flags = (m_alive ? SAVE_STATE_ALIVE : 0) | (m_spikesEnabled ? SAVE_STATE_SPIKES : 0);
+    state.seed = m_seed;
+    state.direction = static_cast<int32_t>(m_direction);
+    state.tickMicros = m_tickMicros;
+    state.score = m_score;
+    state.foodX = m_food.x;
+    state.foodY = m_food.y;
+    state.foodTimer = m_foodTimer;
+    state.spikeAdvanceTimer = m_spikeAdvanceTimer;
+    state.spikeWalls[0] = m_leftSpikeWall;
+    state.spikeWalls[1] = m_rightSpikeWall;
+    state.spikeWalls[2] = m_topSpikeWall;
+    state.spikeWalls[3] = m_bottomSpikeWall;
+    m_rng.getState(state.rngState);
+    state.snakeLength = static_cast<uint32_t>(m_snake.size());
+    state.freeCount = static_cast<uint32_t>(m_freeCells.getFreeCount());
+    state.orderSize = static_cast<uint32_t>(m_freeCells.getOrderSize());
+    state.reserved = 0;
+
+    Point* body = getSaveStateBody(&state);
+    const RingBuffer<Point>::Span first = m_snake.firstSpan();
+    const RingBuffer<Point>::Span second = m_snake.secondSpan();
+    std::copy(first.data, first.data + first.size, body);
+    std::copy(second.data, second.data + second.size, body + first.size);
+    m_freeCells.exportOrder(getSaveStateOrder(&state));
+}
+
+bool GameSim::loadState(const SaveState& state) {
+    const size_t cellCount = static_cast<size_t>(m_width) * m_height;
+    const int32_t* walls = state.spikeWalls;
+    const bool foodValid = (state.foodX == -1 && state.foodY == -1) ||
+                           (state.foodX >= 0 && state.foodX < m_width && state.foodY >= 0 && state.foodY < m_height);
+    if (state.width != m_width || state.height != m_height || state.direction < 0 ||
+        state.direction > static_cast<int32_t>(Direction::NONE) || state.tickMicros <= 0 || state.score < 0 ||
+        state.foodTimer < 0 || state.spikeAdvanceTimer < 0 || !foodValid ||
+        walls[0] < 0 || walls[0] >= walls[1] || walls[1] > m_width ||
+        walls[2] < 0 || walls[2] >= walls[3] || walls[3] > m_height ||
+        (state.rngState[0] | state.rngState[1] | state.rngState[2] | state.rngState[3]) == 0 ||
+        state.snakeLength == 0 || state.snakeLength > cellCount || state.freeCount != cellCount - state.snakeLength ||
+        state.orderSize > cellCount) {
+        return false;
+    }
+
+    // Everything is checked against the slot before the game is touched. The order has to be
+    // a permutation of the slots it lists; the body then has to fill exactly the occupied
+    // part of it, [freeCount, cellCount), which also rules out a body crossing itself
+    const FreeCellSlot* order = getSaveStateOrder(&state);
+    std::vector<FreeCellSlot> byCell;
+    if (!FreeCellIndex::isValidOrder(order, state.orderSize, cellCount, byCell)) return false;
+    auto positionOf = [&byCell](uint32_t cell) {
+        auto it = std::lower_bound(byCell.begin(), byCell.end(), cell,
+                                   [](const FreeCellSlot& entry, uint32_t value) { return entry.cell < value; });
+        return it != byCell.end() && it->cell == cell ? it->slot : cell; // Unlisted cells never moved
+    };
+
+    const Point* body = getSaveStateBody(&state);
+    std::vector<uint32_t> positions(state.snakeLength);
+    for (uint32_t i = 0; i < state.snakeLength; ++i) {
+        if (body[i].x < 0 || body[i].x >= m_width || body[i].y < 0 || body[i].y >= m_height) return false;
+        positions[i] = positionOf(static_cast<uint32_t>(m_occupied.cellIndex(body[i].x, body[i].y)));
+    }
+    std::sort(positions.begin(), positions.end());
+    for (uint32_t i = 0; i < state.snakeLength; ++i) {
+        if (positions[i] != state.freeCount + i) return false;
+    }
+    if (state.foodX >= 0 && positionOf(static_cast<uint32_t>(m_occupied.cellIndex(state.foodX, state.foodY))) >= state.freeCount) {
+        return false;
+    }
+
+    // Same as reset(): only the old body is cleared, then the new one set
+    for (const Point& segment : m_snake) {
+        m_occupied.reset(segment.x, segment.y);
+    }
+    m_snake.assign(body, state.snakeLength);
+    for (const Point& segment : m_snake) {
+        m_occupied.set(segment.x, segment.y);
+    }
+    m_freeCells.importOrder(order, state.orderSize, state.freeCount);
+
+    m_seed = state.seed;
+    m_rng.setState(state.rngState);
+    m_food = {state.foodX, state.foodY};
+    m_direction = static_cast<Direction>(state.direction);
+    m_tickMicros = state.tickMicros;
+    m_score = state.score;
+    m_alive = (state.flags & SAVE_STATE_ALIVE) != 0;
+    m_spikesEnabled = (state.flags & SAVE_STATE_SPIKES) != 0;
+    m_foodTimer = state.foodTimer;
+    m_spikeAdvanceTimer = state.spikeAdvanceTimer;
+    m_leftSpikeWall = walls[0];
+    m_rightSpikeWall = walls[1];
+    m_topSpikeWall = walls[2];
+    m_bottomSpikeWall = walls[3];
+    return true;
+}
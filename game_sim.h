@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+
+#include "bitboard.h"
+#include "free_cells.h"
+#include "ring_buffer.h"
+#include "rng.h"
+
+
+// Board size is chosen at runtime; these are the classic window-sized defaults.
+const int DEFAULT_GRID_WIDTH = 25;
+const int DEFAULT_GRID_HEIGHT = 20;
+const int MAX_GRID_SIDE = 8192; // Keeps cell indices and the replay header's u16 sizes in range
+// Simulated time is kept in integer microseconds so tick scheduling and the spike timers
+// advance exactly, with no float drift between runs or platforms.
+const int32_t INITIAL_TICK_MICROS = 150000;
+const int32_t TICK_MICROS_DECREMENT = 5000;
+const int32_t MIN_TICK_MICROS = 50000;
+const int32_t SPIKE_TIMER_MICROS = 8000000;
+const int32_t SPIKE_ADVANCE_INTERVAL_MICROS = 2000000;
+
+
+struct Point {
+    int x;
+    int y;
+    bool operator==(const Point& other) const { return x == other.x && y == other.y; }
+};
+
+enum class Direction { UP, DOWN, LEFT, RIGHT, NONE };
+
+// Outcome of a single simulation tick
+enum class StepResult { IDLE, MOVED, ATE, DIED };
+
+bool isOppositeDirection(Direction a, Direction b);
+
+struct SaveState;
+
+inline bool isValidBoardSize(int width, int height) {
+    return width >= 1 && height >= 1 && width <= MAX_GRID_SIDE && height <= MAX_GRID_SIDE;
+}
+
+
+// Headless game rules (movement, wall/spike collision, eating, speed-up, spike advance).
+// One step() is one snake move; simulated time advances by the current tick interval,
+// so the result does not depend on frame rate and needs no window.
+// Memory is sized for the board once; after that step() and reset() only touch the cells
+// that change, so their cost does not grow with the board area.
+class GameSim {
+public:
+    // width and height must pass isValidBoardSize().
+    explicit GameSim(unsigned seed = 0, int width = DEFAULT_GRID_WIDTH, int height = DEFAULT_GRID_HEIGHT);
+
+    void reset(unsigned seed);
+    unsigned getSeed() const { return m_seed; }
+
+    // Rule option kept across reset(): with spikes off the walls never advance, so a game can
+    // run until the board is full (benchmarks, solvers).
+    void setSpikesEnabled(bool enabled) { m_spikesEnabled = enabled; }
+    bool areSpikesEnabled() const { return m_spikesEnabled; }
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+
+    // Applies the requested direction (NONE keeps the current one, reversals are ignored)
+    // and moves the snake by one cell.
+    StepResult step(Direction requested);
+
+    const RingBuffer<Point>& getSnake() const { return m_snake; }
+    const Bitboard& getOccupancy() const { return m_occupied; } // Cells covered by the body
+    const FreeCellIndex& getFreeCells() const { return m_freeCells; }
+    Point getFood() const { return m_food; }
+    Direction getDirection() const { return m_direction; }
+    int32_t getTickMicros() const { return m_tickMicros; } // Current tick interval
+    int getScore() const { return m_score; }
+    bool isAlive() const { return m_alive; }
+
+    int getLeftSpikeWall() const { return m_leftSpikeWall; }
+    int getRightSpikeWall() const { return m_rightSpikeWall; }
+    int getTopSpikeWall() const { return m_topSpikeWall; }
+    int getBottomSpikeWall() const { return m_bottomSpikeWall; }
+
+    // FNV-1a over the complete rule state, for checking that two runs ended identically.
+    uint64_t computeStateHash() const;
+
+    // Copies the complete state, RNG and free-cell order included, into a save state slot for
+    // this board (see save_state.h), or back. saveState() leaves queuedDirection to the caller.
+    // loadState() returns false, leaving the game unchanged, for a slot of another board or
+    // with inconsistent contents. The slot's arrays must lie in memory the caller owns.
+    void saveState(SaveState& state) const;
+    bool loadState(const SaveState& state);
+
+private:
+    void resetSpikeWalls();
+    void advanceSpikeWalls(int32_t dtMicros);
+    void spawnFood();
+    void occupyCell(Point p);
+    void releaseCell(Point p);
+
+    int m_width;
+    int m_height;
+    RingBuffer<Point> m_snake;  // Preallocated for a full board, no allocations while playing
+    Bitboard m_occupied;        // Cells covered by the snake body, kept in sync with m_snake
+    FreeCellIndex m_freeCells;  // Complement of m_occupied, used to spawn food in O(1)
+    Point m_food;
+    Direction m_direction;
+    int32_t m_tickMicros;
+    int m_score;
+    bool m_alive;
+    bool m_spikesEnabled;
+
+    int32_t m_foodTimer;         // Microseconds since the food was placed
+    int32_t m_spikeAdvanceTimer; // Microseconds towards the next wall advance
+    int m_leftSpikeWall;
+    int m_rightSpikeWall;
+    int m_topSpikeWall;
+    int m_bottomSpikeWall;
+
+    unsigned m_seed;
+    Rng m_rng; // RngStream::FOOD of m_seed
+};
@@ -0,0 +1,112 @@
+#include "hamiltonian_solver.h"
+
+#include <map>
+#include <mutex>
+#include <utility>
+
+
+namespace {
+
+// Neighbour offsets in Direction order (UP, DOWN, LEFT, RIGHT)
+const int DIRECTION_DX[4] = {0, 0, -1, 1};
+const int DIRECTION_DY[4] = {-1, 1, 0, 0};
+
+// Cell after (x, y) on a board with an even height: row 0 runs right, the other rows snake
+// over columns 1.. width - 1 and the last one comes back up column 0.
+Point serpentineNext(int x, int y, int width, int height) {
+    if (x == 0) return y > 0 ? Point{0, y - 1} : Point{1, 0};
+    if (y % 2 == 0) return x < width - 1 ? Point{x + 1, y} : Point{x, y + 1};
+    if (x > 1) return {x - 1, y};
+    return y < height - 1 ? Point{x, y + 1} : Point{0, y};
+}
+
+}
+
+
+HamiltonianCycle::HamiltonianCycle(int width, int height) : m_width(width), m_height(height) {
+    if (!exists(width, height)) return;
+    const bool transposed = height % 2 != 0;
+    const uint32_t cells = static_cast<uint32_t>(width) * height;
+    m_order.resize(cells);
+    m_cells.resize(cells);
+
+    Point p{0, 0};
+    for (uint32_t order = 0; order < cells; ++order) {
+        const uint32_t cell = static_cast<uint32_t>(p.y * width + p.x);
+        m_order[cell] = order;
+        m_cells[order] = cell;
+        if (transposed) {
+            const Point next = serpentineNext(p.y, p.x, height, width);
+            p = {next.y, next.x};
+        } else {
+            p = serpentineNext(p.x, p.y, width, height);
+        }
+    }
+}
+
+std::shared_ptr<const HamiltonianCycle> HamiltonianCycle::forBoard(int width, int height) {
+    static std::mutex mutex;
+    static std::map<std::pair<int, int>, std::shared_ptr<const HamiltonianCycle>> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const HamiltonianCycle>& cycle = cache[std::make_pair(width, height)];
+    if (!cycle) cycle = std::make_shared<HamiltonianCycle>(width, height);
+    return cycle;
+}
+
+
+Direction HamiltonianSolver::decide(const GameSim& sim) {
+    if (!m_cycle || m_cycle->getWidth() != sim.getWidth() || m_cycle->getHeight() != sim.getHeight()) {
+        m_cycle = HamiltonianCycle::forBoard(sim.getWidth(), sim.getHeight());
+    }
+    if (!m_cycle->isValid()) return m_fallback.decide(sim);
+
+    const HamiltonianCycle& cycle = *m_cycle;
+    const int width = sim.getWidth();
+    const Point head = sim.getSnake().front();
+    const Point tail = sim.getSnake().back();
+    const Point food = sim.getFood();
+    const uint32_t headCell = static_cast<uint32_t>(head.y * width + head.x);
+    const uint32_t nextCell = cycle.getNextCell(headCell);
+    const uint32_t cells = cycle.getLength();
+    const uint32_t length = static_cast<uint32_t>(sim.getSnake().size());
+    if (!m_shortcutsEnabled || food.x < 0 || length * 2 >= cells) return directionTo(head, nextCell);
+
+    // Skip ahead only while the food lies between head and tail, i.e. ahead on the cycle
+    const uint32_t tailDistance =
+        length == 1 ? cells : cycle.getDistance(headCell, static_cast<uint32_t>(tail.y * width + tail.x));
+    const uint32_t foodDistance = cycle.getDistance(headCell, static_cast<uint32_t>(food.y * width + food.x));
+    if (foodDistance >= tailDistance) return directionTo(head, nextCell);
+
+    // Cells jumped over stay free behind the head until the tail passes them. Only eating shrinks
+    // the free run ahead of the head, so keep that run at least as long as the stretch of cycle
+    // from the tail to the new head, jumped cells included.
+    const uint32_t span = cells - tailDistance + 1;
+    uint32_t best = nextCell;
+    uint32_t bestDistance = 1;
+    for (int d = 0; d < 4; ++d) {
+        const int x = head.x + DIRECTION_DX[d];
+        const int y = head.y + DIRECTION_DY[d];
+        if (x < sim.getLeftSpikeWall() || x >= sim.getRightSpikeWall() || y < sim.getTopSpikeWall() ||
+            y >= sim.getBottomSpikeWall() || sim.getOccupancy().test(x, y)) {
+            continue;
+        }
+        const uint32_t cell = static_cast<uint32_t>(y * width + x);
+        const uint32_t distance = cycle.getDistance(headCell, cell);
+        if (distance <= bestDistance || distance > foodDistance) continue;
+        if (tailDistance - distance - 1 < span + distance) continue;
+        best = cell;
+        bestDistance = distance;
+    }
+    if (best != nextCell) m_shortcutCount++;
+    return directionTo(head, best);
+}
+
+Direction HamiltonianSolver::directionTo(Point from, uint32_t cell) const {
+    const int width = m_cycle->getWidth();
+    const int x = static_cast<int>(cell % width);
+    const int y = static_cast<int>(cell / width);
+    if (x > from.x) return Direction::RIGHT;
+    if (x < from.x) return Direction::LEFT;
+    return y > from.y ? Direction::DOWN : Direction::UP;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "autopilot.h"
+#include "game_sim.h"
+
+
+// A closed path through every cell of a width x height board: a serpentine over all columns
+// but the first, returning up column 0 (rows and columns swap when only the width is even).
+// One exists only when the board has an even number of cells and both sides are at least 2;
+// otherwise isValid() is false and the tables are empty.
+class HamiltonianCycle {
+public:
+    HamiltonianCycle(int width, int height);
+
+    // Shared, immutable cycle for a board size; built on first request, then cached for the
+    // life of the process. Safe to call from several threads.
+    static std::shared_ptr<const HamiltonianCycle> forBoard(int width, int height);
+
+    static bool exists(int width, int height) {
+        return width >= 2 && height >= 2 && (width % 2 == 0 || height % 2 == 0);
+    }
+
+    bool isValid() const { return !m_cells.empty(); }
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    uint32_t getLength() const { return static_cast<uint32_t>(m_cells.size()); }
+
+    uint32_t getOrder(uint32_t cell) const { return m_order[cell]; } // Position of a cell along the cycle
+    uint32_t getCell(uint32_t order) const { return m_cells[order]; }
+    uint32_t getNextCell(uint32_t cell) const {
+        const uint32_t next = m_order[cell] + 1;
+        return m_cells[next == m_cells.size() ? 0 : next];
+    }
+
+    // Steps along the cycle from cell a forward to cell b, 0 when they are the same cell.
+    uint32_t getDistance(uint32_t a, uint32_t b) const {
+        const uint32_t from = m_order[a];
+        const uint32_t to = m_order[b];
+        return to >= from ? to - from : to + getLength() - from;
+    }
+
+private:
+    int m_width;
+    int m_height;
+    std::vector<uint32_t> m_order; // Cell index -> position along the cycle
+    std::vector<uint32_t> m_cells; // Position along the cycle -> cell index
+};
+
+
+// Perfect-play steering: follows the board's Hamiltonian cycle, which visits every cell
+// before coming back to the tail. The body then always fills the stretch of cycle behind the
+// head, so the cell ahead is free until the board is full. Each decision is O(1).
+//
+// Shortcuts (off by default) skip ahead along the cycle towards the food while the snake
+// covers less than half the board: only forward, never past the food, and only while the free
+// run ahead of the head stays at least as long as the stretch of cycle the body spans. They
+// cost the guarantee: skipped cells stay free behind the head until the tail passes them, and
+// every meal shrinks the run ahead by one while the tail waits, so food landing straight
+// ahead of the head often enough walls it in against its own tail. That is rare, but it can
+// happen on any board once a single cell was skipped (it has been seen on 4x4), so the solver
+// only takes shortcuts when asked to.
+//
+// Needs spikes off (GameSim::setSpikesEnabled) to fill the board: advancing walls cut the
+// cycle. Boards without a cycle (odd cell count, or a side of 1) use an Autopilot instead.
+class HamiltonianSolver {
+public:
+    // Direction for the next step() of sim. Call once per step.
+    Direction decide(const GameSim& sim);
+
+    // Forgets per-game state; the cached cycle is kept.
+    void reset() { m_fallback.reset(); }
+
+    // Faster games that may, rarely, fail to fill the board (see above).
+    void setShortcutsEnabled(bool enabled) { m_shortcutsEnabled = enabled; }
+    bool isShortcutsEnabled() const { return m_shortcutsEnabled; }
+    uint64_t getShortcutCount() const { return m_shortcutCount; }
+
+private:
+    Direction directionTo(Point from, uint32_t cell) const;
+
+    std::shared_ptr<const HamiltonianCycle> m_cycle;
+    Autopilot m_fallback;
+    bool m_shortcutsEnabled = false;
+    uint64_t m_shortcutCount = 0;
+};
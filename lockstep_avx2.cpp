@@ -0,0 +1,47 @@
+#include "lockstep_lanes.h"
+
+// Built with AVX2 enabled (see CMakeLists.txt); only called on CPUs that have it
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+
+namespace {
+
+// Comparisons produce all-ones lanes, so masks combine with plain bitwise ops
+struct Avx2Lanes {
+    static const size_t WIDTH = 8;
+    typedef __m256i Int;
+
+    static Int load(const int32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(int32_t* p, Int v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static Int splat(int32_t v) { return _mm256_set1_epi32(v); }
+
+    static Int add(Int a, Int b) { return _mm256_add_epi32(a, b); }
+    static Int sub(Int a, Int b) { return _mm256_sub_epi32(a, b); }
+    static Int mul(Int a, Int b) { return _mm256_mullo_epi32(a, b); }
+    static Int bitAnd(Int a, Int b) { return _mm256_and_si256(a, b); }
+    static Int bitOr(Int a, Int b) { return _mm256_or_si256(a, b); }
+    static Int bitXor(Int a, Int b) { return _mm256_xor_si256(a, b); }
+    static Int andNot(Int a, Int b) { return _mm256_andnot_si256(a, b); } // ~a & b
+    static Int equal(Int a, Int b) { return _mm256_cmpeq_epi32(a, b); }
+    static Int greater(Int a, Int b) { return _mm256_cmpgt_epi32(a, b); }
+    static Int select(Int mask, Int a, Int b) { return _mm256_blendv_epi8(b, a, mask); }
+    static Int wordOf(Int cell) { return _mm256_srli_epi32(cell, 5); }
+
+    // Mask of the lanes where bit `bit` of words[word] is set
+    static Int testBits(const uint32_t* words, Int word, Int bit) {
+        Int gathered = _mm256_i32gather_epi32(reinterpret_cast<const int*>(words), word, 4);
+        Int mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), bit);
+        return _mm256_cmpeq_epi32(_mm256_and_si256(gathered, mask), mask);
+    }
+};
+
+}
+
+
+void stepLockstepLanesAvx2(const LockstepLanes& lanes, size_t base, size_t count) {
+    for (size_t offset = 0; offset < count; offset += Avx2Lanes::WIDTH) {
+        stepLockstepLanes<Avx2Lanes>(lanes, base + offset);
+    }
+}
+#endif
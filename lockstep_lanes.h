@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "game_sim.h"
+
+
+// Per-lane outcome flags written by the lane kernels
+const int32_t LOCKSTEP_LANE_MOVED = 1;
+const int32_t LOCKSTEP_LANE_ATE = 2;
+const int32_t LOCKSTEP_LANE_DIED = 4;
+
+// LockstepSim's structure-of-arrays state as the lane kernels see it, one entry per lane.
+struct LockstepLanes {
+    const int32_t* requested;
+    int32_t* dir;
+    const int32_t* alive; // 0 or -1 (all bits set), usable directly as a lane mask
+    const int32_t* headX;
+    const int32_t* headY;
+    const int32_t* foodX;
+    const int32_t* foodY;
+    int32_t* left;
+    int32_t* right;
+    int32_t* top;
+    int32_t* bottom;
+    const int32_t* tickMicros;
+    int32_t* foodTimer;
+    int32_t* spikeAdvanceTimer;
+    // The kernels index occupancy words with 32-bit lanes, so offsets start at the group being
+    // stepped rather than at lane 0, which keeps them small however many games there are
+    const int32_t* wordBase; // First occupancy word of each lane, from the start of its group
+    const uint32_t* occupied; // Words of the group being stepped
+    int32_t width;
+
+    int32_t* laneFlags; // LOCKSTEP_LANE_*
+    int32_t* nextCell;  // Cell the head moves into, when the lane moved
+};
+
+// The SIMD kernels, each in a file of its own built for its instruction set, so nothing else
+// is compiled with flags the CPU may lack; LockstepSim calls one only after checking the CPU.
+// Both step lanes [base, base + count) of one LockstepSim group, count a multiple of 8.
+void stepLockstepLanesAvx2(const LockstepLanes& lanes, size_t base, size_t count);
+void stepLockstepLanesSse41(const LockstepLanes& lanes, size_t base, size_t count);
+
+
+// Lane kernel over Lanes::WIDTH lanes from base: the direction update, spike timers and walls,
+// head move, wall/food compares and the body bit test, with masked updates. Lanes is the
+// instruction set's vector type and operations (see lockstep_avx2.cpp); each kernel file
+// instantiates it with a type of its own, so the instantiations never mix.
+template <typename Lanes>
+void stepLockstepLanes(const LockstepLanes& s, size_t base) {
+    typedef typename Lanes::Int Int;
+    const Int one = Lanes::splat(1);
+    const Int none = Lanes::splat(static_cast<int32_t>(Direction::NONE));
+
+    // Direction: take the request unless it is NONE or a reversal
+    Int alive = Lanes::load(&s.alive[base]);
+    Int requested = Lanes::load(&s.requested[base]);
+    Int dir = Lanes::load(&s.dir[base]);
+    Int reverse = Lanes::equal(Lanes::bitXor(requested, one), dir);
+    Int apply = Lanes::andNot(Lanes::bitOr(reverse, Lanes::equal(requested, none)), alive);
+    dir = Lanes::select(apply, requested, dir);
+    Lanes::store(&s.dir[base], dir);
+    Int active = Lanes::andNot(Lanes::equal(dir, none), alive);
+
+    // Spike timers advance by the tick interval of each game
+    const Int spikeTimer = Lanes::splat(SPIKE_TIMER_MICROS);
+    Int tick = Lanes::load(&s.tickMicros[base]);
+    Int foodTimer = Lanes::load(&s.foodTimer[base]);
+    foodTimer = Lanes::select(Lanes::bitAnd(active, Lanes::greater(spikeTimer, foodTimer)), Lanes::add(foodTimer, tick), foodTimer);
+    Lanes::store(&s.foodTimer[base], foodTimer);
+    Int spiking = Lanes::andNot(Lanes::greater(spikeTimer, foodTimer), active);
+
+    const Int interval = Lanes::splat(SPIKE_ADVANCE_INTERVAL_MICROS);
+    Int advanceTimer = Lanes::load(&s.spikeAdvanceTimer[base]);
+    advanceTimer = Lanes::select(spiking, Lanes::add(advanceTimer, tick), advanceTimer);
+    Int advance = Lanes::andNot(Lanes::greater(interval, advanceTimer), spiking);
+    advanceTimer = Lanes::select(advance, Lanes::sub(advanceTimer, interval), advanceTimer);
+    Lanes::store(&s.spikeAdvanceTimer[base], advanceTimer);
+
+    // Advance walls, ensuring they don't cross (a true mask is -1, so subtracting it adds one)
+    Int left = Lanes::load(&s.left[base]);
+    Int right = Lanes::load(&s.right[base]);
+    Int top = Lanes::load(&s.top[base]);
+    Int bottom = Lanes::load(&s.bottom[base]);
+    left = Lanes::sub(left, Lanes::bitAnd(advance, Lanes::greater(Lanes::sub(right, one), left)));
+    right = Lanes::add(right, Lanes::bitAnd(advance, Lanes::greater(right, Lanes::add(left, one))));
+    top = Lanes::sub(top, Lanes::bitAnd(advance, Lanes::greater(Lanes::sub(bottom, one), top)));
+    bottom = Lanes::add(bottom, Lanes::bitAnd(advance, Lanes::greater(bottom, Lanes::add(top, one))));
+    Lanes::store(&s.left[base], left);
+    Lanes::store(&s.right[base], right);
+    Lanes::store(&s.top[base], top);
+    Lanes::store(&s.bottom[base], bottom);
+
+    // Move the head
+    Int nextX = Lanes::load(&s.headX[base]);
+    Int nextY = Lanes::load(&s.headY[base]);
+    nextX = Lanes::add(Lanes::sub(nextX, Lanes::equal(dir, Lanes::splat(static_cast<int32_t>(Direction::RIGHT)))),
+                       Lanes::equal(dir, Lanes::splat(static_cast<int32_t>(Direction::LEFT))));
+    nextY = Lanes::add(Lanes::sub(nextY, Lanes::equal(dir, Lanes::splat(static_cast<int32_t>(Direction::DOWN)))),
+                       Lanes::equal(dir, Lanes::splat(static_cast<int32_t>(Direction::UP))));
+
+    // Walls lie inside the board, so being inside them also covers the board bounds
+    Int inside = Lanes::andNot(Lanes::bitOr(Lanes::greater(left, nextX), Lanes::greater(top, nextY)),
+                               Lanes::bitAnd(Lanes::greater(right, nextX), Lanes::greater(bottom, nextY)));
+    Int cell = Lanes::bitAnd(Lanes::add(Lanes::mul(nextY, Lanes::splat(s.width)), nextX), inside);
+    Int word = Lanes::add(Lanes::load(&s.wordBase[base]), Lanes::wordOf(cell));
+    Int bodyHit = Lanes::testBits(s.occupied, word, Lanes::bitAnd(cell, Lanes::splat(31)));
+
+    Int died = Lanes::andNot(Lanes::andNot(bodyHit, inside), active);
+    Int moved = Lanes::andNot(died, active);
+    Int ate = Lanes::bitAnd(moved, Lanes::bitAnd(Lanes::equal(nextX, Lanes::load(&s.foodX[base])),
+                                                 Lanes::equal(nextY, Lanes::load(&s.foodY[base]))));
+
+    Int flags = Lanes::bitOr(Lanes::bitAnd(moved, Lanes::splat(LOCKSTEP_LANE_MOVED)),
+                             Lanes::bitOr(Lanes::bitAnd(ate, Lanes::splat(LOCKSTEP_LANE_ATE)),
+                                          Lanes::bitAnd(died, Lanes::splat(LOCKSTEP_LANE_DIED))));
+    Lanes::store(&s.laneFlags[base], flags);
+    Lanes::store(&s.nextCell[base], cell);
+}
@@ -0,0 +1,258 @@
+#include "lockstep_sim.h"
+
+#include <algorithm>
+
+#if defined(SNAKE_LOCKSTEP_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+namespace {
+
+const int32_t DIR_UP = static_cast<int32_t>(Direction::UP);
+const int32_t DIR_DOWN = static_cast<int32_t>(Direction::DOWN);
+const int32_t DIR_LEFT = static_cast<int32_t>(Direction::LEFT);
+const int32_t DIR_RIGHT = static_cast<int32_t>(Direction::RIGHT);
+const int32_t DIR_NONE = static_cast<int32_t>(Direction::NONE);
+
+typedef void (*LaneKernel)(const LockstepLanes& lanes, size_t base, size_t count);
+
+struct KernelChoice {
+    LaneKernel kernel; // Null for the scalar lanes
+    const char* name;
+};
+
+// The widest kernel this CPU runs, checked once
+KernelChoice detectKernel() {
+#if defined(SNAKE_LOCKSTEP_X86)
+    bool sse41;
+    bool avx2 = false;
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    sse41 = (info[2] >> 19) & 1;
+    const bool osUsesAvx = ((info[2] >> 27) & 1) && ((info[2] >> 28) & 1) && (_xgetbv(0) & 6) == 6;
+    if (maxLeaf >= 7 && osUsesAvx) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] >> 5) & 1;
+    }
+#else
+    __builtin_cpu_init();
+    sse41 = __builtin_cpu_supports("sse4.1");
+    avx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (avx2) return {stepLockstepLanesAvx2, "avx2"};
+    if (sse41) return {stepLockstepLanesSse41, "sse4.1"};
+#endif
+    return {nullptr, "scalar"};
+}
+
+const KernelChoice& getKernel() {
+    static const KernelChoice choice = detectKernel();
+    return choice;
+}
+
+}
+
+
+LockstepSim::LockstepSim(size_t gameCount, bool forceScalar, int width, int height)
+    : m_gameCount(gameCount),
+      m_laneCount((gameCount + GROUP_SIZE - 1) / GROUP_SIZE * GROUP_SIZE),
+      m_forceScalar(forceScalar),
+      m_width(width),
+      m_height(height),
+      m_cellCount(static_cast<size_t>(width) * height),
+      m_wordsPerGame((m_cellCount + 31) / 32) {
+    size_t ringCapacity = 1;
+    while (ringCapacity < m_cellCount) ringCapacity <<= 1;
+    m_ringMask = ringCapacity - 1;
+
+    const size_t n = m_laneCount;
+    for (std::vector<int32_t>* lanes : {&m_dir, &m_alive, &m_headX, &m_headY, &m_foodX, &m_foodY, &m_left, &m_right,
+                                        &m_top, &m_bottom, &m_score, &m_wordBase, &m_requested, &m_nextCell, &m_laneFlags}) {
+        lanes->assign(n, 0);
+    }
+    m_tickMicros.assign(n, 0);
+    m_foodTimer.assign(n, 0);
+    m_spikeAdvanceTimer.assign(n, 0);
+    m_occupied.assign(n * m_wordsPerGame, 0);
+    m_body.assign(n * ringCapacity, 0);
+    m_bodyHead.assign(n, 0);
+    m_bodyLength.assign(n, 0);
+    m_freeCells.reserve(n);
+    for (size_t lane = 0; lane < n; ++lane) m_freeCells.emplace_back(m_cellCount); // Copies would drop the reserved scratch
+    m_rng.resize(n);
+
+    for (size_t lane = 0; lane < n; ++lane) {
+        m_wordBase[lane] = static_cast<int32_t>(lane % GROUP_SIZE * m_wordsPerGame);
+        m_requested[lane] = DIR_NONE;
+        resetGame(lane, static_cast<unsigned>(lane));
+        if (lane >= m_gameCount) m_alive[lane] = 0; // Padding lanes never move
+    }
+}
+
+const char* LockstepSim::getBackendName() const {
+    return m_forceScalar ? "scalar" : getKernel().name;
+}
+
+Point LockstepSim::getSegment(size_t game, size_t i) const {
+    uint32_t cell = m_body[game * (m_ringMask + 1) + ((m_bodyHead[game] + i) & m_ringMask)];
+    return {static_cast<int>(cell % m_width), static_cast<int>(cell / m_width)};
+}
+
+void LockstepSim::resetGame(size_t lane, unsigned seed) {
+    m_rng[lane].seed(seed, RngStream::FOOD);
+
+    // Clear only the old body and restore the index order like GameSim::reset(), so the
+    // food sequence only depends on the seed
+    const size_t ring = lane * (m_ringMask + 1);
+    for (uint32_t i = 0; i < m_bodyLength[lane]; ++i) {
+        uint32_t cell = m_body[ring + ((m_bodyHead[lane] + i) & m_ringMask)];
+        m_occupied[lane * m_wordsPerGame + (cell >> 5)] &= ~(1u << (cell & 31));
+    }
+    m_freeCells[lane].clear();
+    m_bodyHead[lane] = 0;
+    m_bodyLength[lane] = 1;
+    uint32_t start = static_cast<uint32_t>((m_height / 2) * m_width + m_width / 2);
+    m_body[ring] = start;
+    occupyCell(lane, start);
+    m_headX[lane] = m_width / 2;
+    m_headY[lane] = m_height / 2;
+
+    m_dir[lane] = DIR_NONE;
+    m_tickMicros[lane] = INITIAL_TICK_MICROS;
+    m_score[lane] = 0;
+    m_alive[lane] = -1;
+    spawnFood(lane);
+}
+
+void LockstepSim::occupyCell(size_t lane, uint32_t cell) {
+    m_occupied[lane * m_wordsPerGame + (cell >> 5)] |= 1u << (cell & 31);
+    m_freeCells[lane].occupy(cell);
+}
+
+void LockstepSim::releaseCell(size_t lane, uint32_t cell) {
+    m_occupied[lane * m_wordsPerGame + (cell >> 5)] &= ~(1u << (cell & 31));
+    m_freeCells[lane].release(cell);
+}
+
+void LockstepSim::resetSpikeWalls(size_t lane) {
+    m_foodTimer[lane] = 0;
+    m_spikeAdvanceTimer[lane] = 0;
+    m_left[lane] = 0;
+    m_right[lane] = m_width;
+    m_top[lane] = 0;
+    m_bottom[lane] = m_height;
+}
+
+void LockstepSim::spawnFood(size_t lane) {
+    if (m_freeCells[lane].getFreeCount() == 0) {
+        m_foodX[lane] = -1;
+        m_foodY[lane] = -1;
+    } else {
+        uint32_t cell = m_freeCells[lane].sample(m_rng[lane]);
+        m_foodX[lane] = static_cast<int32_t>(cell % m_width);
+        m_foodY[lane] = static_cast<int32_t>(cell / m_width);
+    }
+    resetSpikeWalls(lane);
+}
+
+void LockstepSim::step(const Direction* requested, StepResult* results) {
+    for (size_t i = 0; i < m_gameCount; ++i) {
+        m_requested[i] = static_cast<int32_t>(requested[i]);
+    }
+
+    const LaneKernel kernel = m_forceScalar ? nullptr : getKernel().kernel;
+    LockstepLanes lanes = {m_requested.data(), m_dir.data(), m_alive.data(), m_headX.data(), m_headY.data(),
+                                 m_foodX.data(), m_foodY.data(), m_left.data(), m_right.data(), m_top.data(),
+                                 m_bottom.data(), m_tickMicros.data(), m_foodTimer.data(), m_spikeAdvanceTimer.data(),
+                                 m_wordBase.data(), m_occupied.data(), m_width, m_laneFlags.data(), m_nextCell.data()};
+    for (size_t base = 0; base < m_laneCount; base += GROUP_SIZE) {
+        lanes.occupied = &m_occupied[base * m_wordsPerGame];
+        if (kernel) kernel(lanes, base, GROUP_SIZE);
+        else stepLanesScalar(base, GROUP_SIZE);
+
+        const size_t end = std::min(base + GROUP_SIZE, m_gameCount);
+        for (size_t lane = base; lane < end; ++lane) {
+            commitLane(lane, results[lane]);
+        }
+    }
+}
+
+void LockstepSim::stepLanesScalar(size_t base, size_t count) {
+    for (size_t lane = base; lane < base + count; ++lane) {
+        m_laneFlags[lane] = 0;
+        if (!m_alive[lane]) continue;
+
+        int32_t requested = m_requested[lane];
+        if (requested != DIR_NONE && (requested ^ 1) != m_dir[lane]) m_dir[lane] = requested;
+        const int32_t dir = m_dir[lane];
+        if (dir == DIR_NONE) continue;
+
+        if (m_foodTimer[lane] < SPIKE_TIMER_MICROS) m_foodTimer[lane] += m_tickMicros[lane];
+        if (m_foodTimer[lane] >= SPIKE_TIMER_MICROS) {
+            m_spikeAdvanceTimer[lane] += m_tickMicros[lane];
+            if (m_spikeAdvanceTimer[lane] >= SPIKE_ADVANCE_INTERVAL_MICROS) {
+                m_spikeAdvanceTimer[lane] -= SPIKE_ADVANCE_INTERVAL_MICROS;
+                if (m_left[lane] < m_right[lane] - 1) m_left[lane]++;
+                if (m_right[lane] > m_left[lane] + 1) m_right[lane]--;
+                if (m_top[lane] < m_bottom[lane] - 1) m_top[lane]++;
+                if (m_bottom[lane] > m_top[lane] + 1) m_bottom[lane]--;
+            }
+        }
+
+        int32_t nextX = m_headX[lane] + (dir == DIR_RIGHT) - (dir == DIR_LEFT);
+        int32_t nextY = m_headY[lane] + (dir == DIR_DOWN) - (dir == DIR_UP);
+        if (nextX < m_left[lane] || nextX >= m_right[lane] || nextY < m_top[lane] || nextY >= m_bottom[lane]) {
+            m_laneFlags[lane] = LOCKSTEP_LANE_DIED;
+            continue;
+        }
+        int32_t cell = nextY * m_width + nextX;
+        if ((m_occupied[lane * m_wordsPerGame + (cell >> 5)] >> (cell & 31)) & 1u) {
+            m_laneFlags[lane] = LOCKSTEP_LANE_DIED;
+            continue;
+        }
+        m_nextCell[lane] = cell;
+        m_laneFlags[lane] = LOCKSTEP_LANE_MOVED | ((nextX == m_foodX[lane] && nextY == m_foodY[lane]) ? LOCKSTEP_LANE_ATE : 0);
+    }
+}
+
+void LockstepSim::commitLane(size_t lane, StepResult& result) {
+    const int32_t flags = m_laneFlags[lane];
+    if (flags & LOCKSTEP_LANE_DIED) {
+        m_alive[lane] = 0;
+        result = StepResult::DIED;
+        return;
+    }
+    if (!(flags & LOCKSTEP_LANE_MOVED)) {
+        result = StepResult::IDLE;
+        return;
+    }
+
+    const uint32_t cell = static_cast<uint32_t>(m_nextCell[lane]);
+    const size_t ring = lane * (m_ringMask + 1);
+    const int32_t dir = m_dir[lane]; // The kernel's move, cheaper than dividing the cell by the width
+    m_headX[lane] += (dir == DIR_RIGHT) - (dir == DIR_LEFT);
+    m_headY[lane] += (dir == DIR_DOWN) - (dir == DIR_UP);
+    m_bodyHead[lane] = static_cast<uint32_t>((m_bodyHead[lane] - 1) & m_ringMask);
+    m_body[ring + m_bodyHead[lane]] = cell;
+    m_bodyLength[lane]++;
+    occupyCell(lane, cell);
+
+    if (flags & LOCKSTEP_LANE_ATE) {
+        m_score[lane]++;
+        spawnFood(lane);
+        if (m_tickMicros[lane] > MIN_TICK_MICROS) {
+            m_tickMicros[lane] -= TICK_MICROS_DECREMENT;
+        }
+        result = StepResult::ATE;
+        return;
+    }
+
+    const uint32_t tail = m_body[ring + ((m_bodyHead[lane] + m_bodyLength[lane] - 1) & m_ringMask)];
+    m_bodyLength[lane]--;
+    releaseCell(lane, tail);
+    result = StepResult::MOVED;
+}
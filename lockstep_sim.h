@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "free_cells.h"
+#include "game_sim.h"
+#include "lockstep_lanes.h"
+
+
+// Many games on one board size stepped in lockstep, one SIMD lane per game.
+// Per-game state lives in structure-of-arrays form; the direction update, spike timers and
+// walls, head move, wall/food compares and the body bit test run on whole lanes with masked
+// updates, only the body push/pop and food spawn of games that moved are done per lane.
+// Rules, RNG use and results are identical to GameSim for the same seeds and inputs.
+//
+// The lane kernel is picked at runtime for the CPU: AVX2 (8 lanes) or SSE4.1 (4 lanes) on
+// x86-64, scalar code otherwise. Only the kernel files are built for those instruction sets.
+// Most of a step is the per-lane commit (body ring, free-cell index, food), which is the same
+// for every kernel, so the SIMD lanes win on the kernel part only.
+class LockstepSim {
+public:
+    static const size_t GROUP_SIZE = 8; // Game count is padded to a multiple of this
+
+    // Games start as GameSim(i, width, height) would; forceScalar selects the scalar lane
+    // kernel for comparison.
+    explicit LockstepSim(size_t gameCount, bool forceScalar = false, int width = DEFAULT_GRID_WIDTH,
+                         int height = DEFAULT_GRID_HEIGHT);
+
+    void resetGame(size_t game, unsigned seed);
+
+    // Steps every game once. requested and results hold one entry per game.
+    void step(const Direction* requested, StepResult* results);
+
+    size_t getGameCount() const { return m_gameCount; }
+    int getWidth() const { return m_width; }
+    int getHeight() const { return m_height; }
+    const char* getBackendName() const;
+
+    bool isAlive(size_t game) const { return m_alive[game] != 0; }
+    int getScore(size_t game) const { return m_score[game]; }
+    Direction getDirection(size_t game) const { return static_cast<Direction>(m_dir[game]); }
+    int32_t getTickMicros(size_t game) const { return m_tickMicros[game]; }
+    Point getFood(size_t game) const { return {m_foodX[game], m_foodY[game]}; }
+    size_t getLength(size_t game) const { return m_bodyLength[game]; }
+    Point getSegment(size_t game, size_t i) const;
+
+    int getLeftSpikeWall(size_t game) const { return m_left[game]; }
+    int getRightSpikeWall(size_t game) const { return m_right[game]; }
+    int getTopSpikeWall(size_t game) const { return m_top[game]; }
+    int getBottomSpikeWall(size_t game) const { return m_bottom[game]; }
+
+private:
+    void stepLanesScalar(size_t base, size_t count);
+    void commitLane(size_t lane, StepResult& result);
+
+    void occupyCell(size_t lane, uint32_t cell);
+    void releaseCell(size_t lane, uint32_t cell);
+    void spawnFood(size_t lane);
+    void resetSpikeWalls(size_t lane);
+
+    size_t m_gameCount;
+    size_t m_laneCount;
+    bool m_forceScalar;
+    int m_width;
+    int m_height;
+    size_t m_cellCount;
+
+    size_t m_wordsPerGame;  // 32-bit occupancy words per lane
+    size_t m_ringMask;      // Body ring capacity - 1 (power of two)
+
+    std::vector<int32_t> m_dir;
+    std::vector<int32_t> m_alive;    // 0 or -1 (all bits set), usable directly as a lane mask
+    std::vector<int32_t> m_headX;
+    std::vector<int32_t> m_headY;
+    std::vector<int32_t> m_foodX;
+    std::vector<int32_t> m_foodY;
+    std::vector<int32_t> m_left;
+    std::vector<int32_t> m_right;
+    std::vector<int32_t> m_top;
+    std::vector<int32_t> m_bottom;
+    std::vector<int32_t> m_score;
+    std::vector<int32_t> m_tickMicros;
+    std::vector<int32_t> m_foodTimer;
+    std::vector<int32_t> m_spikeAdvanceTimer;
+    std::vector<int32_t> m_wordBase;  // First occupancy word of each lane, from the start of its group
+
+    std::vector<uint32_t> m_occupied;   // m_wordsPerGame words per lane
+    std::vector<uint32_t> m_body;       // Ring of cells per lane, head at m_bodyHead
+    std::vector<uint32_t> m_bodyHead;
+    std::vector<uint32_t> m_bodyLength;
+    std::vector<FreeCellIndex> m_freeCells;
+    std::vector<Rng> m_rng;
+
+    // Scratch written by the lane kernels and consumed by commitLane()
+    std::vector<int32_t> m_requested;
+    std::vector<int32_t> m_nextCell;
+    std::vector<int32_t> m_laneFlags;
+};
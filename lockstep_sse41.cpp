@@ -0,0 +1,48 @@
+#include "lockstep_lanes.h"
+
+// Built with SSE4.1 enabled (see CMakeLists.txt; MSVC needs no flag); only called on CPUs that have it
+#if defined(__SSE4_1__) || defined(_MSC_VER)
+#include <immintrin.h>
+
+
+namespace {
+
+struct Sse41Lanes {
+    static const size_t WIDTH = 4;
+    typedef __m128i Int;
+
+    static Int load(const int32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static void store(int32_t* p, Int v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    static Int splat(int32_t v) { return _mm_set1_epi32(v); }
+
+    static Int add(Int a, Int b) { return _mm_add_epi32(a, b); }
+    static Int sub(Int a, Int b) { return _mm_sub_epi32(a, b); }
+    static Int mul(Int a, Int b) { return _mm_mullo_epi32(a, b); }
+    static Int bitAnd(Int a, Int b) { return _mm_and_si128(a, b); }
+    static Int bitOr(Int a, Int b) { return _mm_or_si128(a, b); }
+    static Int bitXor(Int a, Int b) { return _mm_xor_si128(a, b); }
+    static Int andNot(Int a, Int b) { return _mm_andnot_si128(a, b); } // ~a & b
+    static Int equal(Int a, Int b) { return _mm_cmpeq_epi32(a, b); }
+    static Int greater(Int a, Int b) { return _mm_cmpgt_epi32(a, b); }
+    static Int select(Int mask, Int a, Int b) { return _mm_blendv_epi8(b, a, mask); }
+    static Int wordOf(Int cell) { return _mm_srli_epi32(cell, 5); }
+
+    // SSE has no gather or per-lane shift, so the words are fetched one lane at a time
+    static Int testBits(const uint32_t* words, Int word, Int bit) {
+        const uint32_t w0 = words[_mm_cvtsi128_si32(word)] >> _mm_cvtsi128_si32(bit);
+        const uint32_t w1 = words[_mm_extract_epi32(word, 1)] >> _mm_extract_epi32(bit, 1);
+        const uint32_t w2 = words[_mm_extract_epi32(word, 2)] >> _mm_extract_epi32(bit, 2);
+        const uint32_t w3 = words[_mm_extract_epi32(word, 3)] >> _mm_extract_epi32(bit, 3);
+        return _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(_mm_setr_epi32(static_cast<int>(w0), static_cast<int>(w1), static_cast<int>(w2), static_cast<int>(w3)), _mm_set1_epi32(1)));
+    }
+};
+
+}
+
+
+void stepLockstepLanesSse41(const LockstepLanes& lanes, size_t base, size_t count) {
+    for (size_t offset = 0; offset < count; offset += Sse41Lanes::WIDTH) {
+        stepLockstepLanes<Sse41Lanes>(lanes, base + offset);
+    }
+}
+#endif
@@ -1,7 +1,6 @@
 ﻿#include <SFML/Graphics.hpp>
 #include <SFML/System/Clock.hpp>
 #include <vector>
-#include <deque>
 #include <cstdlib>
 #include <ctime>
 #include <iostream>
@@ -9,52 +8,84 @@
 #include <cmath>
 #include  <algorithm>
 
+#include "arena_sim.h"
+#include "arena_texture.h"
+#include "autopilot.h"
+#include "board_texture.h"
+#include "fixed_timestep.h"
+#include "frame_profiler.h"
+#include "game_sim.h"
+#include "hamiltonian_solver.h"
+#include "particles.h"
+#include "profiler_overlay.h"
+#include "replay.h"
+#include "rng.h"
+#include "save_state.h"
+#include "snake_mesh.h"
+#include "spectator_writer.h"
+#include "spike_mesh.h"
+
+
+const float DEFAULT_BLOCK_SIZE = 28.f;
+const float MIN_GRID_LINE_BLOCK_SIZE = 4.f; // Poniżej tego linie siatki zasłoniłyby planszę
+
+const size_t MAX_DEATH_PARTICLES = 200000; // Długie węże na dużych planszach dostają cząstki co k-ty segment
+const float PARTICLE_SIZE = 4.f;
+const int MAX_TICKS_PER_FRAME = 8; // Limit nadrabiania po zacięciu klatki
+const sf::Int64 HEADLESS_FRAME_MICROS = 16667; // Czas gry na klatkę w trybie --headless (60 fps)
+const int ARENA_DEFAULT_WIDTH = 200; // Plansza areny, gdy nie podano --width / --height
+const int ARENA_DEFAULT_HEIGHT = 120;
 
-const int GRID_WIDTH = 25;
-const int GRID_HEIGHT = 20;
-const float BLOCK_SIZE = 28.f;
-const float WINDOW_WIDTH = GRID_WIDTH * BLOCK_SIZE;
-const float WINDOW_HEIGHT = GRID_HEIGHT * BLOCK_SIZE;
-const float INITIAL_GAME_SPEED = 0.15f;
-const float SPEED_INCREMENT = 0.005f;
-const float MAX_SPEED = 0.05f;
-const float SPIKE_TIMER = 8.0f;
-const float SPIKE_ADVANCE_INTERVAL = 2.0f;
+enum class GameState { STARTING, PLAYING, DYING, GAME_OVER };
 
 
-struct Point {
-    int x;
-    int y;
-    bool operator==(const Point& other) const { return x == other.x && y == other.y; }
-};
+// Rozmiar planszy i bloku wybierany przy starcie (--width / --height / --block)
+float blockSize = DEFAULT_BLOCK_SIZE;
+float windowWidth = DEFAULT_GRID_WIDTH * DEFAULT_BLOCK_SIZE;
+float windowHeight = DEFAULT_GRID_HEIGHT * DEFAULT_BLOCK_SIZE;
 
+sf::RenderWindow window;
+sf::RenderTexture offscreenTexture; // Cel rysowania w trybie --headless
+sf::RenderTarget* renderTarget = &window; // Całe rysowanie idzie tutaj: okno albo tekstura poza ekranem
+GameSim sim;
+Direction nextDirection = Direction::NONE;
+sf::Clock gameClock;
+FixedTimestep tickScheduler(MAX_TICKS_PER_FRAME);
+GameState currentGameState = GameState::STARTING;
 
-struct Particle {
-    sf::Vector2f pos;
-    sf::Vector2f vel;
-    sf::Color color;
-    float lifetime;
-    float initialLifetime;
-};
+// Autopilot: najkrótsza droga do jedzenia (--autopilot / klawisz P)
+Autopilot autopilot;
+bool autopilotMode = false;
 
-enum class Direction { UP, DOWN, LEFT, RIGHT, NONE };
+// Solver: cykl Hamiltona bez skrótów, bez kolców, gra aż do zapełnienia planszy (--solver)
+HamiltonianSolver solver;
+bool solverMode = false;
 
-enum class GameState { STARTING, PLAYING, DYING, GAME_OVER };
+// Arena: gracz jako wąż 0 wśród botów na jednej planszy (--arena N)
+size_t arenaSnakes = 0;
 
+// Nagrywanie i odtwarzanie powtórek (--record / --replay)
+std::string recordPath;
+ReplayRecorder replayRecorder;
+bool replayMode = false;
+Replay loadedReplay;
+ReplayPlayer replayPlayer(&loadedReplay);
+float replaySpeed = 1.f;
+
+// Strumień dla widzów: delty każdego ruchu do pliku, FIFO albo stdout, zapisywane w tle (--spectate)
+SpectatorWriter spectator;
+
+// Zapis stanu: F5 zapisuje całą grę do pliku, F9 wczytuje ją przez mmap i od razu wznawia (--state)
+std::string statePath = "snake.snkt";
 
-sf::RenderWindow window;
-std::deque<Point> snake;
-Point food;
-Direction currentDirection = Direction::NONE;
-Direction nextDirection = Direction::NONE;
-sf::Clock gameClock;
-float timeSinceLastUpdate = 0.f;
-float currentGameSpeed = INITIAL_GAME_SPEED;
-GameState currentGameState = GameState::STARTING;
-int score = 0;
 
+// Osobny strumień losowości na każde zastosowanie: cząstki i trzęsienie nie zmieniają kolejnych gier
+Rng gameSeedRng;
+Rng particleRng;
+Rng shakeRng;
 
-std::vector<Particle> deathParticles;
+ParticlePool deathParticles(MAX_DEATH_PARTICLES);
+std::vector<sf::Vertex> particleVertices;
 float dyingTimer = 0.f; const float DYING_DURATION = 0.8f;
 sf::View defaultView; sf::View shakeView;
 float shakeTimer = 0.f; float shakeMagnitude = 0.f; const float SHAKE_DURATION = 0.3f; const float SHAKE_INTENSITY = 4.0f;
@@ -62,52 +93,41 @@ float scorePulseTimer = 0.f; const float SCORE_PULSE_DURATION = 0.3f;
 float gameOverAppearTimer = 0.f; const float GAME_OVER_APPEAR_DURATION = 0.4f;
 
 
-float foodTimer = 0.f;
-float spikeAdvanceTimer = 0.f;
-int leftSpikeWall = 0;
-int rightSpikeWall = GRID_WIDTH;
-int topSpikeWall = 0;
-int bottomSpikeWall = GRID_HEIGHT;
-
-
 sf::Font font;
+
+// Profiler klatki: zawsze mierzy, nakładka pod F3
+FrameProfiler frameProfiler;
+ProfilerOverlay profilerOverlay(font);
+bool showProfiler = false;
 sf::Text scoreText; sf::Text instructionsText; sf::Text gameOverText; sf::Text restartText;
 sf::VertexArray gridLines(sf::Lines);
-sf::CircleShape foodShape(BLOCK_SIZE / 2.f);
-sf::RectangleShape segmentShape(sf::Vector2f(BLOCK_SIZE * 0.9f, BLOCK_SIZE * 0.9f));
-sf::CircleShape particleShape(2.f);
+sf::CircleShape foodShape;
+SnakeMesh snakeMesh(blockSize);
 
-sf::RectangleShape spikeShape(sf::Vector2f(BLOCK_SIZE * 0.8f, BLOCK_SIZE * 0.8f));
+SpikeMesh spikeMesh(blockSize);
 
+// Tryb tilemapy: cała plansza jako tekstura, aktualizowane tylko zmienione komórki (--tilemap / klawisz T)
+BoardTexture boardTexture(blockSize);
+bool tilemapMode = false;
 
 
-float randomFloat(float min, float max) {
-    return min + static_cast<float>(rand()) / (static_cast<float>(RAND_MAX / (max - min)));
+
+// Rysowanie z liczeniem wywołań dla profilera; drawCalls to liczba wywołań, które obiekt wykonuje sam
+void drawCounted(const sf::Drawable& drawable, unsigned drawCalls = 1) {
+    renderTarget->draw(drawable);
+    frameProfiler.countDrawCall(drawCalls);
 }
 
-void resetSpikeWalls() {
-    foodTimer = 0.f;
-    spikeAdvanceTimer = 0.f;
-    leftSpikeWall = 0;
-    rightSpikeWall = GRID_WIDTH;
-    topSpikeWall = 0;
-    bottomSpikeWall = GRID_HEIGHT;
+// Wszystkie strumienie z jednego ziarna (--seed), więc przebieg da się powtórzyć
+void seedRandomStreams(uint64_t seed) {
+    gameSeedRng.seed(seed, RngStream::GAME_SEED);
+    particleRng.seed(seed, RngStream::PARTICLES);
+    shakeRng.seed(seed, RngStream::CAMERA_SHAKE);
 }
 
-void spawnFood() {
-    bool onSnake;
-    do {
-        onSnake = false;
-        food = {rand() % GRID_WIDTH, rand() % GRID_HEIGHT};
-        for (const auto& segment : snake) {
-            if (segment == food) {
-                onSnake = true;
-                break;
-            }
-        }
-    } while (onSnake);
-    foodShape.setPosition(food.x * BLOCK_SIZE + BLOCK_SIZE * 0.5f, food.y * BLOCK_SIZE + BLOCK_SIZE * 0.5f);
-    resetSpikeWalls();
+void syncFoodShape() {
+    Point food = sim.getFood();
+    foodShape.setPosition(food.x * blockSize + blockSize * 0.5f, food.y * blockSize + blockSize * 0.5f);
 }
 
 
@@ -115,26 +135,45 @@ void triggerDeathAnimation() {
     currentGameState = GameState::DYING;
     dyingTimer = DYING_DURATION;
     deathParticles.clear();
-    sf::Color headColor = sf::Color(0, 255, 0);
-    sf::Color bodyColor = sf::Color(0, 200, 0);
+    const RingBuffer<Point>& snake = sim.getSnake();
+    const uint32_t headColor = 0x00FF00;
+    const uint32_t bodyColor = 0x00C800;
 
-    for(size_t i = 0; i < snake.size(); ++i) {
+    // Przy bardzo długim wężu cząstki tylko dla co k-tego segmentu, żeby zmieścić się w puli
+    const size_t segmentStride = std::max<size_t>(1, (15 * snake.size() + MAX_DEATH_PARTICLES - 1) / MAX_DEATH_PARTICLES);
+    for(size_t i = 0; i < snake.size(); i += (i == 0) ? 1 : segmentStride) {
         Point seg = snake[i];
-        sf::Vector2f centerPos(seg.x * BLOCK_SIZE + BLOCK_SIZE * 0.5f, seg.y * BLOCK_SIZE + BLOCK_SIZE * 0.5f);
+        sf::Vector2f centerPos(seg.x * blockSize + blockSize * 0.5f, seg.y * blockSize + blockSize * 0.5f);
         int numParticles = (i == 0) ? 25 : 15; // Więcej cząstek dla głowy
-        for(int j = 0; j < numParticles; ++j) {
-            float angle = randomFloat(0.f, 2.f * M_PI);
-            float speed = randomFloat(50.f, 150.f);
-            float lifetime = randomFloat(DYING_DURATION * 0.5f, DYING_DURATION);
-            deathParticles.push_back({
-                centerPos, // Pozycja startowa
-                {std::cos(angle) * speed, std::sin(angle) * speed}, // Prędkość
-                (i == 0) ? headColor : bodyColor,
-                lifetime,
-                lifetime
-            });
-        }
+        deathParticles.spawnBurst(centerPos.x, centerPos.y, numParticles, // Pozycja startowa
+                                  50.f, 150.f, // Zakres prędkości
+                                  DYING_DURATION * 0.5f, DYING_DURATION, // Zakres czasu życia
+                                  (i == 0) ? headColor : bodyColor, particleRng);
+    }
+}
+
+
+// Wszystkie cząstki jako jedna lista quadów, jedno wywołanie draw
+void drawParticles() {
+    const size_t count = deathParticles.size();
+    if (count == 0) return;
+    particleVertices.resize(count * 4);
+    const float* posX = deathParticles.getPosX();
+    const float* posY = deathParticles.getPosY();
+    const uint32_t* colors = deathParticles.getColor();
+    const float half = PARTICLE_SIZE * 0.5f;
+    for (size_t i = 0; i < count; ++i) {
+        // Zmniejszaj alpha (przezroczystość) w miarę upływu życia
+        sf::Color color(static_cast<sf::Uint8>(colors[i] >> 16), static_cast<sf::Uint8>(colors[i] >> 8),
+                        static_cast<sf::Uint8>(colors[i]), static_cast<sf::Uint8>(255 * deathParticles.getLifeFraction(i)));
+        sf::Vertex* quad = &particleVertices[i * 4];
+        quad[0] = sf::Vertex(sf::Vector2f(posX[i] - half, posY[i] - half), color);
+        quad[1] = sf::Vertex(sf::Vector2f(posX[i] + half, posY[i] - half), color);
+        quad[2] = sf::Vertex(sf::Vector2f(posX[i] + half, posY[i] + half), color);
+        quad[3] = sf::Vertex(sf::Vector2f(posX[i] - half, posY[i] + half), color);
     }
+    renderTarget->draw(particleVertices.data(), particleVertices.size(), sf::Quads);
+    frameProfiler.countDrawCall();
 }
 
 
@@ -143,17 +182,29 @@ void triggerCameraShake() {
     shakeMagnitude = SHAKE_INTENSITY;
 }
 
-void setupGame() {
-    snake.clear();
-    snake.push_front({GRID_WIDTH / 2, GRID_HEIGHT / 2});
-    currentDirection = Direction::NONE;
-    nextDirection = Direction::NONE;
-    score = 0;
-    scoreText.setString("Score: 0");
+void saveRecording() {
+    if (recordPath.empty() || replayMode) return;
+    if (!replayRecorder.finish(sim).saveToFile(recordPath)) {
+        std::cerr << "Error saving replay to " << recordPath << std::endl;
+    }
+}
+
+void enableTilemap() {
+    tilemapMode = boardTexture.reset(sim);
+    if (!tilemapMode) std::cerr << "Board is too large for a texture, using shape rendering" << std::endl;
+}
+
+// Wszystko poza samą symulacją od nowa dla bieżącego stanu sim: widzowie, autopilot, grafika, efekty
+void resetGameView() {
+    spectator.begin(sim);
+    autopilot.reset();
+    solver.reset();
+    snakeMesh.reset(sim.getSnake());
+    if (tilemapMode) enableTilemap();
+    syncFoodShape();
+    scoreText.setString("Score: " + std::to_string(sim.getScore()));
     scoreText.setScale(1.f, 1.f); // Resetuj skalę wyniku
-    currentGameSpeed = INITIAL_GAME_SPEED;
-    spawnFood();
-    timeSinceLastUpdate = 0;
+    tickScheduler.reset();
     deathParticles.clear();
     shakeTimer = 0.f;
     scorePulseTimer = 0.f;
@@ -161,7 +212,50 @@ void setupGame() {
     gameOverText.setScale(0.f, 0.f);
     restartText.setScale(0.f, 0.f);
     gameClock.restart();
-    resetSpikeWalls();
+}
+
+void setupGame() {
+    if (replayMode) {
+        replayPlayer.start(sim);
+    } else {
+        sim.reset(gameSeedRng.next());
+    }
+    replayRecorder.begin(sim);
+    nextDirection = Direction::NONE;
+    resetGameView();
+}
+
+void saveGameState() {
+    SaveStateFile file;
+    if (!file.create(statePath, sim.getWidth(), sim.getHeight(), {getSaveStateSize(sim)})) {
+        std::cerr << "Error saving state to " << statePath << std::endl;
+        return;
+    }
+    file.save(0, sim, nextDirection);
+}
+
+// Nie podczas nagrywania: powtórka zawsze zaczyna się od ziarna, wczytanej gry by nie odtworzyła
+void loadGameState() {
+    SaveStateFile file;
+    if (!file.open(statePath) || file.getWidth() != sim.getWidth() || file.getHeight() != sim.getHeight()) {
+        std::cerr << "No state for a " << sim.getWidth() << "x" << sim.getHeight() << " board in " << statePath << std::endl;
+        return;
+    }
+    Direction queued = Direction::NONE;
+    if (!file.load(0, sim, &queued)) { // Uszkodzony plik: sim pozostaje bez zmian, gra toczy się dalej
+        std::cerr << "Error loading state from " << statePath << std::endl;
+        return;
+    }
+    nextDirection = queued;
+    resetGameView();
+    if (!sim.isAlive()) {
+        triggerDeathAnimation();
+    } else if (sim.getDirection() == Direction::NONE && queued == Direction::NONE) {
+        currentGameState = GameState::STARTING; // Zapisane przed pierwszym ruchem
+    } else {
+        currentGameState = GameState::PLAYING;
+        tickScheduler.reset(sim.getTickMicros());
+    }
 }
 
 void setupTexts() {
@@ -173,55 +267,469 @@ void setupTexts() {
          }
     }
     scoreText.setFont(font); scoreText.setCharacterSize(24); scoreText.setFillColor(sf::Color::White); scoreText.setPosition(10.f, 5.f);
-    instructionsText.setFont(font); instructionsText.setCharacterSize(28); instructionsText.setFillColor(sf::Color::Cyan); instructionsText.setString("Use WASD or Arrow Keys to Move\n\nPress any movement key to Start!");
-    sf::FloatRect textRect = instructionsText.getLocalBounds(); instructionsText.setOrigin(textRect.left + textRect.width / 2.0f, textRect.top + textRect.height / 2.0f); instructionsText.setPosition(WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f);
+    instructionsText.setFont(font); instructionsText.setCharacterSize(28); instructionsText.setFillColor(sf::Color::Cyan); instructionsText.setString("Use WASD or Arrow Keys to Move\n\nPress any movement key to Start!\nP: autopilot, F5/F9: save/load");
+    sf::FloatRect textRect = instructionsText.getLocalBounds(); instructionsText.setOrigin(textRect.left + textRect.width / 2.0f, textRect.top + textRect.height / 2.0f); instructionsText.setPosition(windowWidth / 2.0f, windowHeight / 2.0f);
     gameOverText.setFont(font); gameOverText.setCharacterSize(60); gameOverText.setFillColor(sf::Color::Red); gameOverText.setString("GAME OVER!");
-    textRect = gameOverText.getLocalBounds(); gameOverText.setOrigin(textRect.left + textRect.width / 2.0f, textRect.top + textRect.height / 2.0f); gameOverText.setPosition(WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f - 50.f);
+    textRect = gameOverText.getLocalBounds(); gameOverText.setOrigin(textRect.left + textRect.width / 2.0f, textRect.top + textRect.height / 2.0f); gameOverText.setPosition(windowWidth / 2.0f, windowHeight / 2.0f - 50.f);
     restartText.setFont(font); restartText.setCharacterSize(24); restartText.setFillColor(sf::Color::Yellow); restartText.setString("Press SPACE to Restart");
-    textRect = restartText.getLocalBounds(); restartText.setOrigin(textRect.left + textRect.width / 2.0f, textRect.top + textRect.height / 2.0f); restartText.setPosition(WINDOW_WIDTH / 2.0f, WINDOW_HEIGHT / 2.0f + 50.f);
+    textRect = restartText.getLocalBounds(); restartText.setOrigin(textRect.left + textRect.width / 2.0f, textRect.top + textRect.height / 2.0f); restartText.setPosition(windowWidth / 2.0f, windowHeight / 2.0f + 50.f);
 }
 
 void setupGrid() {
     // (Bez zmian - tworzenie linii siatki)
     gridLines.clear(); sf::Color gridColor(50, 50, 50);
-    for (int x = 0; x <= GRID_WIDTH; ++x) { gridLines.append(sf::Vertex(sf::Vector2f(x * BLOCK_SIZE, 0.f), gridColor)); gridLines.append(sf::Vertex(sf::Vector2f(x * BLOCK_SIZE, WINDOW_HEIGHT), gridColor)); }
-    for (int y = 0; y <= GRID_HEIGHT; ++y) { gridLines.append(sf::Vertex(sf::Vector2f(0.f, y * BLOCK_SIZE), gridColor)); gridLines.append(sf::Vertex(sf::Vector2f(WINDOW_WIDTH, y * BLOCK_SIZE), gridColor)); }
+    if (blockSize < MIN_GRID_LINE_BLOCK_SIZE) return; // Na dużych planszach bez siatki
+    for (int x = 0; x <= sim.getWidth(); ++x) { gridLines.append(sf::Vertex(sf::Vector2f(x * blockSize, 0.f), gridColor)); gridLines.append(sf::Vertex(sf::Vector2f(x * blockSize, windowHeight), gridColor)); }
+    for (int y = 0; y <= sim.getHeight(); ++y) { gridLines.append(sf::Vertex(sf::Vector2f(0.f, y * blockSize), gridColor)); gridLines.append(sf::Vertex(sf::Vector2f(windowWidth, y * blockSize), gridColor)); }
 }
 
 
-// --- Główna Funkcja Gry ---
-int main() {
-    srand(static_cast<unsigned>(time(0)));
+// Animacje i logika stanu gry za jedną klatkę
+void updateFrame(sf::Time frameTime) {
+    float dt = frameTime.asSeconds();
+
+    // Aktualizacja animacji niezależnie od stanu (np. trzęsienie, pulsowanie)
+    if (shakeTimer > 0) {
+        shakeTimer -= dt;
+        float currentMagnitude = shakeMagnitude * (shakeTimer / SHAKE_DURATION); // Zmniejszaj intensywność
+        float offsetX = shakeRng.nextRange(-currentMagnitude, currentMagnitude);
+        float offsetY = shakeRng.nextRange(-currentMagnitude, currentMagnitude);
+        shakeView.setCenter(defaultView.getCenter() + sf::Vector2f(offsetX, offsetY));
+         renderTarget->setView(shakeView); // Ustaw widok tylko jeśli się trzęsie
+    } else {
+         renderTarget->setView(defaultView); // Wróć do normalnego widoku
+    }
+
+    if (scorePulseTimer > 0) {
+         scorePulseTimer -= dt;
+         float pulse = sin((SCORE_PULSE_DURATION - scorePulseTimer) / SCORE_PULSE_DURATION * M_PI); // Fala sinus 0..1..0
+         float scale = 1.0f + 0.3f * pulse;
+         scoreText.setScale(scale, scale);
+    } else {
+         scoreText.setScale(1.f, 1.f); // Wróć do normalnej skali
+    }
+
+
+    switch (currentGameState) {
+        case GameState::PLAYING: {
+            // Stały krok symulacji: tyle ruchów, ile upłynęło czasu (także przy szybkim odtwarzaniu)
+            sf::Int64 elapsedMicros = frameTime.asMicroseconds();
+            if (replayMode) {
+                elapsedMicros = static_cast<sf::Int64>(elapsedMicros * static_cast<double>(replaySpeed));
+                tickScheduler.setMaxTicksPerFrame(MAX_TICKS_PER_FRAME * std::max(1, static_cast<int>(std::ceil(replaySpeed))));
+            }
+            tickScheduler.beginFrame(elapsedMicros);
+
+            while (currentGameState == GameState::PLAYING && tickScheduler.consumeTick(sim.getTickMicros())) {
+
+                if (replayMode && replayPlayer.isFinished()) { // Nagranie przerwane przed końcem gry
+                    currentGameState = GameState::GAME_OVER;
+                    gameOverAppearTimer = GAME_OVER_APPEAR_DURATION;
+                    break;
+                }
+
+                if (solverMode && !replayMode) nextDirection = solver.decide(sim);
+                else if (autopilotMode && !replayMode) nextDirection = autopilot.decide(sim);
+                StepResult result = replayMode ? replayPlayer.step(sim) : sim.step(nextDirection);
+                replayRecorder.record(sim);
+                spectator.record(sim, result);
+                if (tilemapMode) boardTexture.update(sim);
+                switch (result) {
+                    case StepResult::DIED:
+                        saveRecording();
+                        triggerDeathAnimation(); // Rozpocznij animację śmierci zamiast od razu GAME OVER
+                        triggerCameraShake();    // Rozpocznij trzęsienie ekranu
+                        break;
+                    case StepResult::ATE:
+                        snakeMesh.pushHead(sim.getSnake().front());
+                        scoreText.setString("Score: " + std::to_string(sim.getScore()));
+                        syncFoodShape();
+                        scorePulseTimer = SCORE_PULSE_DURATION; // Wyzwalacz pulsowania wyniku
+                        break;
+                    case StepResult::MOVED:
+                        snakeMesh.pushHead(sim.getSnake().front());
+                        snakeMesh.popTail();
+                        break;
+                    case StepResult::IDLE:
+                        break;
+                }
+            }
+            // Płynny ruch między krokami przy wysokim odświeżaniu
+            if (currentGameState == GameState::PLAYING) snakeMesh.setInterpolation(tickScheduler.getAlpha(sim.getTickMicros()));
+            break;
+        } // Koniec case PLAYING
+
+        case GameState::DYING: {
+             dyingTimer -= dt;
+             // Aktualizuj cząsteczki
+             deathParticles.update(dt);
+
+             // Przejdź do GAME_OVER po zakończeniu animacji
+             if (dyingTimer <= 0) {
+                  currentGameState = GameState::GAME_OVER;
+                  gameOverAppearTimer = GAME_OVER_APPEAR_DURATION; // Rozpocznij animację pojawiania się tekstu
+             }
+             break;
+        }
+
+         case GameState::GAME_OVER: {
+
+              if (gameOverAppearTimer > 0) {
+                   gameOverAppearTimer -= dt;
+                   float scale = 1.0f - (gameOverAppearTimer / GAME_OVER_APPEAR_DURATION);
+                   scale = std::min(1.0f, std::max(0.0f, scale)); // Ogranicz skalę do [0, 1]
+                   gameOverText.setScale(scale, scale);
+                   restartText.setScale(scale, scale);
+              } else {
+                   gameOverText.setScale(1.f, 1.f); // Upewnij się, że jest w pełnej skali
+                   restartText.setScale(1.f, 1.f);
+              }
+              break;
+         }
+
+        case GameState::STARTING: // Brak logiki update dla STARTING
+            break;
+    }
+}
+
+// Cała klatka do renderTarget (okno albo tekstura poza ekranem)
+void drawFrame(float dt) {
+    renderTarget->clear(sf::Color(20, 20, 20));
+    // Rysuj siatkę zawsze (w trybie tilemapy podczas gry siatka jest nakładką tekstury)
+    if (!tilemapMode || currentGameState != GameState::PLAYING) drawCounted(gridLines);
+
+    switch (currentGameState) {
+        case GameState::STARTING:
+            drawCounted(instructionsText);
+            break;
+
+        case GameState::PLAYING:
+             if (tilemapMode) {
+                 drawCounted(boardTexture, boardTexture.getDrawCallCount()); // Jedzenie, kolce i wąż w jednym quadzie
+                 drawCounted(scoreText);
+                 break;
+             }
+             foodShape.setFillColor(sf::Color::Red);
+             drawCounted(foodShape);
+
+             spikeMesh.update(sim); // Przebudowa tylko gdy ściany się przesunęły
+             drawCounted(spikeMesh);
+
+             // Rysuj węża
+             drawCounted(snakeMesh); // Jedno wywołanie dla całego ciała
+
+             drawCounted(scoreText);
+            break;
+
+        case GameState::DYING:
+             // Rysuj jedzenie (może być widoczne podczas animacji)
+              drawCounted(foodShape);
+
+             drawParticles();
+
+              drawCounted(scoreText);
+             break;
+
+        case GameState::GAME_OVER:
+             // Rysuj jedzenie (może być widoczne)
+              drawCounted(foodShape);
+             // Rysuj wynik
+             drawCounted(scoreText);
+             // Rysuj teksty końca gry (ze skalowaniem)
+             drawCounted(gameOverText);
+             drawCounted(restartText);
+            break;
+    }
+
+    if (showProfiler) {
+        renderTarget->setView(defaultView); // Nakładka nie trzęsie się razem z planszą
+        std::string counters = "segments: " + std::to_string(snakeMesh.getSegmentCount()) +
+                               "\nparticles: " + std::to_string(deathParticles.size()) +
+                               "\nticks this frame: " + std::to_string(tickScheduler.getTicksThisFrame());
+        profilerOverlay.setPosition(windowWidth - profilerOverlay.getWidth(), 0.f);
+        profilerOverlay.update(frameProfiler, counters, dt);
+        drawCounted(profilerOverlay, profilerOverlay.getDrawCallCount());
+    }
+}
+
+// Tryb --headless: N klatek gry (autopilota albo powtórki) do tekstury poza ekranem, bez okna
+// i bez limitu klatek. Czas gry płynie o HEADLESS_FRAME_MICROS na klatkę, więc każdy przebieg
+// rysuje to samo; mierzony jest tylko czas rzeczywisty. Na serwerze bez ekranu wystarczy
+// programowy OpenGL (np. Xvfb z Mesa llvmpipe).
+int runHeadless(int frames) {
+    if (!offscreenTexture.create(static_cast<unsigned>(windowWidth), static_cast<unsigned>(windowHeight))) {
+        std::cerr << "Error creating offscreen render texture (no OpenGL context?)" << std::endl;
+        return 1;
+    }
+    renderTarget = &offscreenTexture;
+    if (!replayMode && !solverMode) autopilotMode = true;
+    defaultView = offscreenTexture.getDefaultView();
+    shakeView = defaultView;
+
+    const sf::Time frameTime = sf::microseconds(HEADLESS_FRAME_MICROS);
+    int gamesStarted = 0;
+    sf::Clock wallClock;
+    for (int frame = 0; frame < frames; ++frame) {
+        frameProfiler.beginFrame();
+        // Zamiast klawiszy: start od razu, restart po pokazaniu ekranu końca gry
+        if (currentGameState == GameState::GAME_OVER && gameOverAppearTimer <= 0) {
+            setupGame();
+            currentGameState = GameState::STARTING;
+        }
+        if (currentGameState == GameState::STARTING) {
+            currentGameState = GameState::PLAYING;
+            tickScheduler.reset(sim.getTickMicros());
+            gamesStarted++;
+        }
+        frameProfiler.endPhase(FramePhase::EVENTS);
+
+        updateFrame(frameTime);
+        frameProfiler.endPhase(FramePhase::UPDATE);
+        drawFrame(frameTime.asSeconds());
+        frameProfiler.endPhase(FramePhase::DRAW);
+        offscreenTexture.display();
+        frameProfiler.endPhase(FramePhase::DISPLAY);
+        frameProfiler.endFrame();
+    }
+    // Odczyt obrazu czeka, aż GPU skończy wszystkie zlecone klatki
+    sf::Image lastFrame = offscreenTexture.getTexture().copyToImage();
+    float seconds = wallClock.getElapsedTime().asSeconds();
+
+    FrameStats stats = frameProfiler.computeStats();
+    std::cout << "board: " << sim.getWidth() << "x" << sim.getHeight() << ", block " << blockSize << " px, "
+              << lastFrame.getSize().x << "x" << lastFrame.getSize().y << " target, "
+              << (tilemapMode ? "tilemap" : "shapes") << " rendering" << std::endl;
+    std::cout << "frames: " << frames << " in " << seconds << " s, games: " << gamesStarted << std::endl;
+    std::cout << "frames/s: " << (seconds > 0.f ? frames / seconds : 0.f) << std::endl;
+    std::cout << "last " << stats.frames << " frames ms: p50 " << stats.p50Ms << ", p99 " << stats.p99Ms
+              << ", max " << stats.maxMs << ", draw calls " << stats.drawCalls << std::endl;
+    return 0;
+}
+
+// Tryb --arena: własna pętla okna. Boty i gracz ruszają się razem co ARENA_TICK_MICROS, gracz
+// po śmierci odradza się w losowym miejscu i czeka na klawisz kierunku.
+int runArena() {
+    ArenaSim arena(sim.getWidth(), sim.getHeight(), arenaSnakes, std::max<size_t>(1, arenaSnakes / 2),
+                   static_cast<uint32_t>(gameSeedRng.next()));
+    Rng botRng(gameSeedRng.next(), RngStream::POLICY);
+    ArenaTexture arenaTexture(blockSize);
+    if (!arenaTexture.reset(arena)) {
+        std::cerr << "Board is too large for a texture" << std::endl;
+        return 1;
+    }
+    std::vector<Direction> directions(arenaSnakes, Direction::NONE);
+    Direction playerDirection = Direction::NONE;
+    uint64_t playerDeaths = 0;
 
-    window.create(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "SFML Snake++ Professional");
+    window.create(sf::VideoMode(windowWidth, windowHeight), "SFML Snake++ Professional - Arena");
     window.setFramerateLimit(60);
+    defaultView = window.getDefaultView();
+    tickScheduler.reset(ARENA_TICK_MICROS);
+    gameClock.restart();
 
-    defaultView = window.getDefaultView(); // Zapisz domyślny widok
-    shakeView = defaultView;              // Inicjalizuj widok do trzęsienia
+    while (window.isOpen()) {
+        frameProfiler.beginFrame();
+        sf::Time frameTime = gameClock.restart();
+
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed) window.close();
+            if (event.type != sf::Event::KeyPressed) continue;
+            if (event.key.code == sf::Keyboard::F3) showProfiler = !showProfiler;
+            Direction requestedDirection = playerDirection;
+            if (event.key.code == sf::Keyboard::W || event.key.code == sf::Keyboard::Up) requestedDirection = Direction::UP;
+            else if (event.key.code == sf::Keyboard::S || event.key.code == sf::Keyboard::Down) requestedDirection = Direction::DOWN;
+            else if (event.key.code == sf::Keyboard::A || event.key.code == sf::Keyboard::Left) requestedDirection = Direction::LEFT;
+            else if (event.key.code == sf::Keyboard::D || event.key.code == sf::Keyboard::Right) requestedDirection = Direction::RIGHT;
+            if (!isOppositeDirection(requestedDirection, arena.getSnake(0).direction)) playerDirection = requestedDirection;
+        }
+        frameProfiler.endPhase(FramePhase::EVENTS);
+
+        tickScheduler.beginFrame(frameTime.asMicroseconds());
+        while (tickScheduler.consumeTick(ARENA_TICK_MICROS)) {
+            directions[0] = playerDirection;
+            for (size_t i = 1; i < arenaSnakes; ++i) directions[i] = arena.pickBotDirection(i, botRng);
+            const bool wasAlive = arena.isAlive(0);
+            arena.step(directions.data());
+            arenaTexture.update(arena);
+            if (wasAlive && !arena.isAlive(0)) { // Po odrodzeniu wąż stoi, aż gracz wybierze kierunek
+                playerDirection = Direction::NONE;
+                playerDeaths++;
+            }
+        }
+        scoreText.setString("Score: " + std::to_string(arena.isAlive(0) ? arena.getSnake(0).score : 0) +
+                            "   Deaths: " + std::to_string(playerDeaths) +
+                            "   Alive: " + std::to_string(arena.getAliveCount()) + "/" + std::to_string(arenaSnakes));
+        frameProfiler.endPhase(FramePhase::UPDATE);
+
+        window.clear(sf::Color(20, 20, 20));
+        drawCounted(arenaTexture); // Cała plansza w jednym quadzie
+        drawCounted(scoreText);
+        if (showProfiler) {
+            std::string counters = "changed cells: " + std::to_string(arena.getChangedCells().size()) +
+                                   "\nticks this frame: " + std::to_string(tickScheduler.getTicksThisFrame());
+            profilerOverlay.setPosition(windowWidth - profilerOverlay.getWidth(), 0.f);
+            profilerOverlay.update(frameProfiler, counters, frameTime.asSeconds());
+            drawCounted(profilerOverlay, profilerOverlay.getDrawCallCount());
+        }
+        frameProfiler.endPhase(FramePhase::DRAW);
+
+        window.display();
+        frameProfiler.endPhase(FramePhase::DISPLAY);
+        frameProfiler.endFrame();
+    }
+    return 0;
+}
+
+// --- Główna Funkcja Gry ---
+int main(int argc, char** argv) {
+    uint64_t seed = static_cast<uint64_t>(time(0));
+    std::string replayPath;
+    std::string spectatePath;
+    int gridWidth = DEFAULT_GRID_WIDTH;
+    int gridHeight = DEFAULT_GRID_HEIGHT;
+    float requestedBlockSize = 0.f; // 0 = dopasuj do ekranu
+    int headlessFrames = 0; // > 0 = bez okna, pomiar klatek/s
+    bool boardSizeGiven = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--record" && i + 1 < argc) recordPath = argv[++i];
+        else if (arg == "--replay" && i + 1 < argc) replayPath = argv[++i];
+        else if (arg == "--spectate" && i + 1 < argc) spectatePath = argv[++i];
+        else if (arg == "--speed" && i + 1 < argc) replaySpeed = std::max(0.01f, static_cast<float>(std::atof(argv[++i])));
+        else if (arg == "--width" && i + 1 < argc) { gridWidth = std::atoi(argv[++i]); boardSizeGiven = true; }
+        else if (arg == "--height" && i + 1 < argc) { gridHeight = std::atoi(argv[++i]); boardSizeGiven = true; }
+        else if (arg == "--block" && i + 1 < argc) requestedBlockSize = static_cast<float>(std::atof(argv[++i]));
+        else if (arg == "--tilemap") tilemapMode = true;
+        else if (arg == "--autopilot") autopilotMode = true;
+        else if (arg == "--solver") solverMode = true;
+        else if (arg == "--arena" && i + 1 < argc) arenaSnakes = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+        else if (arg == "--headless" && i + 1 < argc) headlessFrames = std::atoi(argv[++i]);
+        else if (arg == "--seed" && i + 1 < argc) seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--state" && i + 1 < argc) statePath = argv[++i];
+        else {
+            std::cerr << "Usage: Snake [--width W] [--height H] [--block pixels] [--tilemap] [--autopilot] [--solver] [--arena snakes] [--record file.snkr] [--replay file.snkr [--speed multiplier]] [--spectate file|-] [--headless frames] [--seed N] [--state file.snkt]" << std::endl;
+            return 1;
+        }
+    }
+    if (!replayPath.empty()) {
+        if (!loadedReplay.loadFromFile(replayPath)) {
+            std::cerr << "Error loading replay " << replayPath << std::endl;
+            return 1;
+        }
+        gridWidth = loadedReplay.width; // Powtórka zawsze na swojej planszy
+        gridHeight = loadedReplay.height;
+        replayMode = true;
+    }
+    if (arenaSnakes > 0) {
+        if (replayMode || !recordPath.empty() || !spectatePath.empty() || headlessFrames > 0) {
+            std::cerr << "--arena cannot be combined with --record, --replay, --spectate or --headless" << std::endl;
+            return 1;
+        }
+        if (!boardSizeGiven) {
+            gridWidth = ARENA_DEFAULT_WIDTH;
+            gridHeight = ARENA_DEFAULT_HEIGHT;
+        }
+    }
+    if (!isValidBoardSize(gridWidth, gridHeight)) {
+        std::cerr << "Board size must be between 1x1 and " << MAX_GRID_SIDE << "x" << MAX_GRID_SIDE << std::endl;
+        return 1;
+    }
+    // Węże i jedzenie areny zajmują najwyżej połowę planszy, reszta to miejsce na ruch i odradzanie
+    if (arenaSnakes > 0 && arenaSnakes * 3 > static_cast<size_t>(gridWidth) * gridHeight) {
+        std::cerr << "Too many snakes for a " << gridWidth << "x" << gridHeight << " arena" << std::endl;
+        return 1;
+    }
+    seedRandomStreams(seed);
+    sim = GameSim(0, gridWidth, gridHeight);
+    sim.setSpikesEnabled(!solverMode);
+    if (!spectatePath.empty()) spectator.start(spectatePath, sim);
+
+    // Domyślnie największy blok (do DEFAULT_BLOCK_SIZE), przy którym okno mieści się na ekranie
+    if (requestedBlockSize > 0.f) {
+        blockSize = requestedBlockSize;
+    } else if (headlessFrames > 0) {
+        // Bez ekranu: domyślny blok, o ile obraz mieści się w teksturze
+        float fit = static_cast<float>(sf::Texture::getMaximumSize()) / std::max(gridWidth, gridHeight);
+        blockSize = std::min(DEFAULT_BLOCK_SIZE, fit >= 1.f ? std::floor(fit) : fit);
+    } else {
+        sf::VideoMode desktop = sf::VideoMode::getDesktopMode();
+        float fit = std::min(desktop.width * 0.9f / gridWidth, desktop.height * 0.9f / gridHeight);
+        blockSize = std::min(DEFAULT_BLOCK_SIZE, fit >= 1.f ? std::floor(fit) : fit);
+    }
+    windowWidth = std::ceil(gridWidth * blockSize);
+    windowHeight = std::ceil(gridHeight * blockSize);
+    snakeMesh.setBlockSize(blockSize);
+    spikeMesh.setBlockSize(blockSize);
+    boardTexture.setBlockSize(blockSize);
+    if (blockSize < MIN_GRID_LINE_BLOCK_SIZE) tilemapMode = true; // Kształty nie skalują się do tak dużych plansz
+    foodShape.setRadius(std::max(blockSize / 2.f, 1.f));
 
     setupTexts();
     setupGrid();
     foodShape.setFillColor(sf::Color::Red);
-    foodShape.setOrigin(BLOCK_SIZE / 2.f, BLOCK_SIZE / 2.f);
-    segmentShape.setOrigin(BLOCK_SIZE * 0.45f, BLOCK_SIZE * 0.45f);
-    segmentShape.setOutlineThickness(1.f);
-    segmentShape.setOutlineColor(sf::Color(30, 30, 30));
-    particleShape.setOrigin(particleShape.getRadius(), particleShape.getRadius()); // Origin cząstki w środku
+    foodShape.setOrigin(foodShape.getRadius(), foodShape.getRadius());
+    particleVertices.reserve(MAX_DEATH_PARTICLES * 4);
+
+    if (arenaSnakes > 0) return runArena();
 
     setupGame(); // Ustaw stan początkowy
-    currentGameState = GameState::STARTING; // Zacznij od ekranu startowego
+    currentGameState = replayMode ? GameState::PLAYING : GameState::STARTING; // Zacznij od ekranu startowego
+
+    if (headlessFrames > 0) return runHeadless(headlessFrames);
+
+    window.create(sf::VideoMode(windowWidth, windowHeight), replayMode ? "SFML Snake++ Professional - Replay" : "SFML Snake++ Professional");
+    window.setFramerateLimit(60);
+
+    defaultView = window.getDefaultView(); // Zapisz domyślny widok
+    shakeView = defaultView;              // Inicjalizuj widok do trzęsienia
+    gameClock.restart();
 
     // --- Główna Pętla Gry ---
     while (window.isOpen()) {
-        float dt = gameClock.restart().asSeconds(); // Delta time
+        frameProfiler.beginFrame();
+        sf::Time frameTime = gameClock.restart();
+        float dt = frameTime.asSeconds(); // Delta time
 
         // --- Obsługa Zdarzeń (Input) ---
         sf::Event event;
         while (window.pollEvent(event)) {
             if (event.type == sf::Event::Closed) {
+                if (currentGameState == GameState::PLAYING) saveRecording(); // Zapisz przerwaną grę
                 window.close();
             }
 
+            // Prędkość odtwarzania powtórki: +/- podwaja lub połowi
+            if (replayMode && event.type == sf::Event::KeyPressed) {
+                if (event.key.code == sf::Keyboard::Add || event.key.code == sf::Keyboard::Equal) replaySpeed *= 2.f;
+                else if (event.key.code == sf::Keyboard::Subtract || event.key.code == sf::Keyboard::Hyphen) replaySpeed = std::max(0.01f, replaySpeed * 0.5f);
+            }
+
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3) showProfiler = !showProfiler;
+
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::P && !replayMode) {
+                autopilotMode = !autopilotMode;
+                if (autopilotMode && currentGameState == GameState::STARTING) { // Autopilot sam rusza
+                    currentGameState = GameState::PLAYING;
+                    tickScheduler.reset(sim.getTickMicros());
+                }
+            }
+
+            // Zapis i wczytanie stanu; w powtórce stan pochodzi z nagrania
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F5 && !replayMode &&
+                (currentGameState == GameState::STARTING || currentGameState == GameState::PLAYING)) {
+                saveGameState();
+            }
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F9 && !replayMode) {
+                if (recordPath.empty()) loadGameState();
+                else std::cerr << "Loading a state is disabled while recording a replay" << std::endl;
+            }
+
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::T) {
+                if (tilemapMode) tilemapMode = false;
+                else enableTilemap();
+            }
+
             if (event.type == sf::Event::KeyPressed) {
                 switch (currentGameState) {
                     case GameState::STARTING: {
@@ -233,30 +741,26 @@ int main() {
 
                         if (requestedDirection != Direction::NONE) {
                              currentGameState = GameState::PLAYING;
-                             currentDirection = requestedDirection;
                              nextDirection = requestedDirection;
-                             timeSinceLastUpdate = currentGameSpeed; // Wymuś aktualizację w pierwszej klatce PLAYING
+                             tickScheduler.reset(sim.getTickMicros()); // Wymuś aktualizację w pierwszej klatce PLAYING
                         }
                         break;
                     }
                     case GameState::PLAYING: {
+                        if (replayMode) break; // Kierunki pochodzą z powtórki
                         Direction requestedDirection = nextDirection;
                          if (event.key.code == sf::Keyboard::W || event.key.code == sf::Keyboard::Up) requestedDirection = Direction::UP;
                          else if (event.key.code == sf::Keyboard::S || event.key.code == sf::Keyboard::Down) requestedDirection = Direction::DOWN;
                          else if (event.key.code == sf::Keyboard::A || event.key.code == sf::Keyboard::Left) requestedDirection = Direction::LEFT;
                          else if (event.key.code == sf::Keyboard::D || event.key.code == sf::Keyboard::Right) requestedDirection = Direction::RIGHT;
 
-                        if (currentDirection == Direction::UP && requestedDirection != Direction::DOWN) nextDirection = requestedDirection;
-                        else if (currentDirection == Direction::DOWN && requestedDirection != Direction::UP) nextDirection = requestedDirection;
-                        else if (currentDirection == Direction::LEFT && requestedDirection != Direction::RIGHT) nextDirection = requestedDirection;
-                        else if (currentDirection == Direction::RIGHT && requestedDirection != Direction::LEFT) nextDirection = requestedDirection;
-                        // Jeśli currentDirection jest NONE (pierwszy ruch po starcie), to już obsłużone w STARTING
+                        if (!isOppositeDirection(requestedDirection, sim.getDirection())) nextDirection = requestedDirection;
                         break;
                     }
                     case GameState::GAME_OVER: {
                         if (event.key.code == sf::Keyboard::Space) {
                             setupGame(); // Zresetuj stan gry
-                            currentGameState = GameState::STARTING; // <<< POPRAWKA: Wróć do STARTING
+                            currentGameState = replayMode ? GameState::PLAYING : GameState::STARTING; // <<< POPRAWKA: Wróć do STARTING
                         }
                         break;
                     }
@@ -266,219 +770,18 @@ int main() {
             }
         }
 
-        // Aktualizacja animacji niezależnie od stanu (np. trzęsienie, pulsowanie)
-        if (shakeTimer > 0) {
-            shakeTimer -= dt;
-            float currentMagnitude = shakeMagnitude * (shakeTimer / SHAKE_DURATION); // Zmniejszaj intensywność
-            float offsetX = randomFloat(-currentMagnitude, currentMagnitude);
-            float offsetY = randomFloat(-currentMagnitude, currentMagnitude);
-            shakeView.setCenter(defaultView.getCenter() + sf::Vector2f(offsetX, offsetY));
-             window.setView(shakeView); // Ustaw widok tylko jeśli się trzęsie
-        } else {
-             window.setView(defaultView); // Wróć do normalnego widoku
-        }
-
-        if (scorePulseTimer > 0) {
-             scorePulseTimer -= dt;
-             float pulse = sin((SCORE_PULSE_DURATION - scorePulseTimer) / SCORE_PULSE_DURATION * M_PI); // Fala sinus 0..1..0
-             float scale = 1.0f + 0.3f * pulse;
-             scoreText.setScale(scale, scale);
-        } else {
-             scoreText.setScale(1.f, 1.f); // Wróć do normalnej skali
-        }
-
-
-        switch (currentGameState) {
-            case GameState::PLAYING: {
-                timeSinceLastUpdate += dt;
-                // *** Spike Timer Logic ***
-                foodTimer += dt;
-                if (foodTimer >= SPIKE_TIMER) { // Start advancing spikes if food isn't eaten
-                    spikeAdvanceTimer += dt;
-                    if (spikeAdvanceTimer >= SPIKE_ADVANCE_INTERVAL) {
-                        spikeAdvanceTimer -= SPIKE_ADVANCE_INTERVAL; // Reset timer for next interval
-
-                        // Advance walls, ensuring they don't cross
-                        if (leftSpikeWall < rightSpikeWall - 1) leftSpikeWall++;
-                        if (rightSpikeWall > leftSpikeWall + 1) rightSpikeWall--; // Use rightSpikeWall > leftSpikeWall + 1 to prevent overlap
-                        if (topSpikeWall < bottomSpikeWall - 1) topSpikeWall++;
-                        if (bottomSpikeWall > topSpikeWall + 1) bottomSpikeWall--; // Use bottomSpikeWall > topSpikeWall + 1
-                    }
-                }
-
-                if (timeSinceLastUpdate >= currentGameSpeed) {
-                    timeSinceLastUpdate -= currentGameSpeed;
-
-                    if (nextDirection != Direction::NONE) {
-                        currentDirection = nextDirection;
-                    }
-
-                    if (currentDirection != Direction::NONE) {
-                        Point newHead = snake.front();
-                        switch (currentDirection) {
-                            case Direction::UP:    newHead.y--; break;
-                            case Direction::DOWN:  newHead.y++; break;
-                            case Direction::LEFT:  newHead.x--; break;
-                            case Direction::RIGHT: newHead.x++; break;
-                            case Direction::NONE: break;
-                        }
-
-                        bool collision = false;
-                        if (newHead.x < 0 || newHead.x >= GRID_WIDTH || newHead.y < 0 || newHead.y >= GRID_HEIGHT ||newHead.x < leftSpikeWall || newHead.x >= rightSpikeWall ||
-                    newHead.y < topSpikeWall || newHead.y >= bottomSpikeWall) {
-                            collision = true; // Kolizja ze ścianą
-                        } else {
-                            for (size_t i = 0; i < snake.size(); ++i) {
-                                if (snake[i] == newHead) {
-                                    collision = true; // Kolizja z samym sobą
-                                    break;
-                                }
-                            }
-                        }
-
-                        if (collision) {
-                             triggerDeathAnimation(); // Rozpocznij animację śmierci zamiast od razu GAME OVER
-                             triggerCameraShake();    // Rozpocznij trzęsienie ekranu
-                        } else {
-                            snake.push_front(newHead);
-                            if (newHead == food) {
-                                score++;
-                                scoreText.setString("Score: " + std::to_string(score));
-                                spawnFood();
-                                scorePulseTimer = SCORE_PULSE_DURATION; // Wyzwalacz pulsowania wyniku
-                                if (currentGameSpeed > MAX_SPEED) {
-                                    currentGameSpeed -= SPEED_INCREMENT;
-                                }
-                            } else {
-                                snake.pop_back();
-                            }
-                        }
-                    }
-                }
-                break;
-            } // Koniec case PLAYING
-
-            case GameState::DYING: {
-                 dyingTimer -= dt;
-                 // Aktualizuj cząsteczki
-                 for (auto it = deathParticles.begin(); it != deathParticles.end(); /* Brak inkrementacji */) {
-                      it->lifetime -= dt;
-                      if (it->lifetime <= 0) {
-                           it = deathParticles.erase(it); // Usuń martwe cząstki
-                      } else {
-                           it->pos += it->vel * dt;
-                           // Zmniejszaj alpha (przezroczystość) w miarę upływu życia
-                           sf::Color color = it->color;
-                           color.a = static_cast<sf::Uint8>(255 * (it->lifetime / it->initialLifetime));
-                           it->color = color;
-                           ++it;
-                      }
-                 }
-
-                 // Przejdź do GAME_OVER po zakończeniu animacji
-                 if (dyingTimer <= 0) {
-                      currentGameState = GameState::GAME_OVER;
-                      gameOverAppearTimer = GAME_OVER_APPEAR_DURATION; // Rozpocznij animację pojawiania się tekstu
-                 }
-                 break;
-            }
-
-             case GameState::GAME_OVER: {
-
-                  if (gameOverAppearTimer > 0) {
-                       gameOverAppearTimer -= dt;
-                       float scale = 1.0f - (gameOverAppearTimer / GAME_OVER_APPEAR_DURATION);
-                       scale = std::min(1.0f, std::max(0.0f, scale)); // Ogranicz skalę do [0, 1]
-                       gameOverText.setScale(scale, scale);
-                       restartText.setScale(scale, scale);
-                  } else {
-                       gameOverText.setScale(1.f, 1.f); // Upewnij się, że jest w pełnej skali
-                       restartText.setScale(1.f, 1.f);
-                  }
-                  break;
-             }
-
-            case GameState::STARTING: // Brak logiki update dla STARTING
-                break;
-        }
-
-
-
-        window.clear(sf::Color(20, 20, 20));
-        window.draw(gridLines); // Rysuj siatkę zawsze
-
-        switch (currentGameState) {
-            case GameState::STARTING:
-                window.draw(instructionsText);
-                break;
+        frameProfiler.endPhase(FramePhase::EVENTS);
 
-            case GameState::PLAYING:
+        updateFrame(frameTime);
+        frameProfiler.endPhase(FramePhase::UPDATE);
 
-                 foodShape.setFillColor(sf::Color::Red);
-                 window.draw(foodShape);
 
-                spikeShape.setFillColor(sf::Color::Yellow); // Or any color you like
-                spikeShape.setOrigin(BLOCK_SIZE * 0.4f, BLOCK_SIZE * 0.4f); // Center origin
-
-
-                for (int x = leftSpikeWall; x < rightSpikeWall; ++x) {
-                    if (topSpikeWall > 0) { // Draw top only if it has advanced
-                        spikeShape.setPosition(x * BLOCK_SIZE + BLOCK_SIZE * 0.5f, (topSpikeWall -1) * BLOCK_SIZE + BLOCK_SIZE * 0.5f);
-                        window.draw(spikeShape);
-                    }
-                    if (bottomSpikeWall < GRID_HEIGHT) { // Draw bottom only if it has advanced
-                        spikeShape.setPosition(x * BLOCK_SIZE + BLOCK_SIZE * 0.5f, bottomSpikeWall * BLOCK_SIZE + BLOCK_SIZE * 0.5f);
-                        window.draw(spikeShape);
-                    }
-                }
-                // Draw Left and Right Spike Walls (avoid drawing corners twice)
-                for (int y = topSpikeWall; y < bottomSpikeWall; ++y) {
-                    if (leftSpikeWall > 0) { // Draw left only if it has advanced
-                        spikeShape.setPosition((leftSpikeWall - 1) * BLOCK_SIZE + BLOCK_SIZE * 0.5f, y * BLOCK_SIZE + BLOCK_SIZE * 0.5f);
-                        window.draw(spikeShape);
-                    }
-                    if (rightSpikeWall < GRID_WIDTH) { // Draw right only if it has advanced
-                        spikeShape.setPosition(rightSpikeWall * BLOCK_SIZE + BLOCK_SIZE * 0.5f, y * BLOCK_SIZE + BLOCK_SIZE * 0.5f);
-                        window.draw(spikeShape);
-                    }
-                }
-                // *** End Draw Spikes ***
-
-                 // Rysuj węża
-                 for (size_t i = 0; i < snake.size(); ++i) {
-                     segmentShape.setPosition(snake[i].x * BLOCK_SIZE + BLOCK_SIZE * 0.5f, snake[i].y * BLOCK_SIZE + BLOCK_SIZE * 0.5f);
-                     segmentShape.setFillColor(i == 0 ? sf::Color(0, 255, 0) : sf::Color(0, 200, 0));
-                     window.draw(segmentShape);
-                 }
-
-                 window.draw(scoreText);
-                break;
-
-            case GameState::DYING:
-                 // Rysuj jedzenie (może być widoczne podczas animacji)
-                  window.draw(foodShape);
-
-                 for (const auto& p : deathParticles) {
-                      particleShape.setPosition(p.pos);
-                      particleShape.setFillColor(p.color);
-                      window.draw(particleShape);
-                 }
-                 
-                  window.draw(scoreText);
-                 break;
-
-            case GameState::GAME_OVER:
-                 // Rysuj jedzenie (może być widoczne)
-                  window.draw(foodShape);
-                 // Rysuj wynik
-                 window.draw(scoreText);
-                 // Rysuj teksty końca gry (ze skalowaniem)
-                 window.draw(gameOverText);
-                 window.draw(restartText);
-                break;
-        }
+        drawFrame(dt);
+        frameProfiler.endPhase(FramePhase::DRAW);
 
         window.display();
+        frameProfiler.endPhase(FramePhase::DISPLAY);
+        frameProfiler.endFrame();
     } // Koniec pętli gry
 
     return 0;
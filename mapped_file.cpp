@@ -0,0 +1,113 @@
+#include "mapped_file.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+#if defined(_WIN32)
+
+bool MappedFile::open(const std::string& path, bool writable) {
+    close();
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | (writable ? GENERIC_WRITE : 0), FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    const bool mapped = GetFileSizeEx(file, &size) && size.QuadPart > 0 &&
+                        map(reinterpret_cast<intptr_t>(file), static_cast<size_t>(size.QuadPart), writable);
+    CloseHandle(file);
+    return mapped;
+}
+
+bool MappedFile::create(const std::string& path, size_t size) {
+    close();
+    if (size == 0) return false;
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER end;
+    end.QuadPart = static_cast<LONGLONG>(size);
+    const bool mapped = SetFilePointerEx(file, end, nullptr, FILE_BEGIN) && SetEndOfFile(file) &&
+                        map(reinterpret_cast<intptr_t>(file), size, true);
+    CloseHandle(file);
+    return mapped;
+}
+
+bool MappedFile::map(intptr_t file, size_t size, bool writable) {
+    const uint64_t size64 = size;
+    // The view keeps the mapping alive, so the handle can be closed right away
+    HANDLE mapping = CreateFileMappingA(reinterpret_cast<HANDLE>(file), nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+                                        static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64), nullptr);
+    if (!mapping) return false;
+    void* data = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+    CloseHandle(mapping);
+    if (!data) return false;
+    m_data = static_cast<uint8_t*>(data);
+    m_size = size;
+    m_writable = writable;
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_data) UnmapViewOfFile(m_data);
+    m_data = nullptr;
+    m_size = 0;
+    m_writable = false;
+}
+
+bool MappedFile::flush() {
+    return m_data && FlushViewOfFile(m_data, m_size);
+}
+
+#else
+
+bool MappedFile::open(const std::string& path, bool writable) {
+    close();
+    const int file = ::open(path.c_str(), writable ? O_RDWR : O_RDONLY);
+    if (file < 0) return false;
+    struct stat info;
+    const bool mapped = fstat(file, &info) == 0 && info.st_size > 0 &&
+                        map(file, static_cast<size_t>(info.st_size), writable);
+    ::close(file);
+    return mapped;
+}
+
+bool MappedFile::create(const std::string& path, size_t size) {
+    close();
+    if (size == 0) return false;
+    const int file = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file < 0) return false;
+    // ftruncate() extends with zeros without writing them, so creating a large file is instant
+    const bool mapped = ftruncate(file, static_cast<off_t>(size)) == 0 && map(file, size, true);
+    ::close(file);
+    return mapped;
+}
+
+bool MappedFile::map(intptr_t file, size_t size, bool writable) {
+    void* data = mmap(nullptr, size, PROT_READ | (writable ? PROT_WRITE : 0), MAP_SHARED, static_cast<int>(file), 0);
+    if (data == MAP_FAILED) return false;
+    m_data = static_cast<uint8_t*>(data);
+    m_size = size;
+    m_writable = writable;
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_data) munmap(m_data, m_size);
+    m_data = nullptr;
+    m_size = 0;
+    m_writable = false;
+}
+
+bool MappedFile::flush() {
+    return m_data && msync(m_data, m_size, MS_SYNC) == 0;
+}
+
+#endif
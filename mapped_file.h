@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+// A whole file mapped into memory (mmap, or a file mapping on Windows). Reads and writes go
+// straight to the page cache, so large files of fixed-size records cost no parsing and no
+// copies into a buffer of our own.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Maps an existing, non-empty file.
+    bool open(const std::string& path, bool writable = false);
+    // Creates or truncates path to size zero-filled bytes and maps it read-write.
+    bool create(const std::string& path, size_t size);
+    void close();
+    // Writes dirty pages back to the file (they are written on close() or exit anyway).
+    bool flush();
+
+    bool isOpen() const { return m_data != nullptr; }
+    bool isWritable() const { return m_writable; }
+    uint8_t* getData() const { return m_data; }
+    size_t getSize() const { return m_size; }
+
+private:
+    bool map(intptr_t file, size_t size, bool writable); // Leaves file open
+
+    uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_writable = false;
+};
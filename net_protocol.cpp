@@ -0,0 +1,196 @@
+#include "net_protocol.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "byte_io.h"
+
+
+namespace {
+
+const uint8_t SKIP_TOKEN = 0x80;
+const size_t MAX_SKIP = 128;
+const size_t MAX_RUN = 16;
+
+// The cells of view as seen from a side x side window at (originX, originY); cells the
+// view did not cover are EMPTY, exactly like the all-empty baseline of a keyframe.
+void moveView(const SnapshotView& view, int side, int32_t originX, int32_t originY, std::vector<uint8_t>& out) {
+    std::fill(out.begin(), out.end(), static_cast<uint8_t>(ViewCell::EMPTY));
+    const int32_t dx = originX - view.originX;
+    const int32_t dy = originY - view.originY;
+    if (dx <= -side || dx >= side || dy <= -side || dy >= side) return;
+    const int firstColumn = std::max(0, -dx);
+    const int endColumn = std::min(side, side - dx);
+    for (int y = std::max(0, -dy); y < std::min(side, side - dy); ++y) {
+        std::memcpy(&out[static_cast<size_t>(y) * side + firstColumn],
+                    &view.cells[static_cast<size_t>(y + dy) * side + firstColumn + dx],
+                    static_cast<size_t>(endColumn - firstColumn));
+    }
+}
+
+}
+
+
+uint32_t viewChecksum(const uint8_t* cells, size_t count) {
+    // Eight cells per multiply; a byte-at-a-time hash would be the slowest part of a snapshot
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ count;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, cells + i, 8);
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    }
+    for (; i < count; ++i) hash = (hash ^ cells[i]) * 0x100000001B3ull;
+    hash ^= hash >> 29;
+    return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+void writeNetHeader(std::vector<uint8_t>& out, NetMessage message) {
+    ByteWriter writer(out);
+    writer.putU16(NET_MAGIC);
+    writer.putU8(static_cast<uint8_t>(message));
+}
+
+bool readNetHeader(const uint8_t* data, size_t size, NetMessage& message) {
+    ByteReader reader(data, size);
+    uint16_t magic;
+    uint8_t type;
+    if (!reader.getU16(magic) || !reader.getU8(type) || magic != NET_MAGIC) return false;
+    if (type < static_cast<uint8_t>(NetMessage::CONNECT) || type > static_cast<uint8_t>(NetMessage::DISCONNECT)) return false;
+    message = static_cast<NetMessage>(type);
+    return true;
+}
+
+
+SnapshotEncoder::SnapshotEncoder(int viewRadius)
+    : m_side(2 * std::min(std::max(viewRadius, 0), NET_MAX_VIEW_RADIUS) + 1),
+      m_sent(NET_SNAPSHOT_HISTORY),
+      m_baseline(static_cast<size_t>(m_side) * m_side) {
+}
+
+void SnapshotEncoder::reset() {
+    for (SnapshotView& view : m_sent) view.tick = NET_NO_TICK;
+}
+
+bool SnapshotEncoder::encode(SnapshotHeader header, const uint8_t* view, uint32_t ackedTick, std::vector<uint8_t>& out) {
+    const size_t cellCount = m_baseline.size();
+    const SnapshotView& acked = m_sent[ackedTick % NET_SNAPSHOT_HISTORY];
+    if (ackedTick != NET_NO_TICK && acked.tick == ackedTick && ackedTick < header.tick) {
+        moveView(acked, m_side, header.originX, header.originY, m_baseline);
+        header.baselineTick = ackedTick;
+    } else {
+        std::fill(m_baseline.begin(), m_baseline.end(), static_cast<uint8_t>(ViewCell::EMPTY));
+        header.baselineTick = NET_NO_TICK;
+    }
+    header.checksum = viewChecksum(view, cellCount);
+
+    writeNetHeader(out, NetMessage::SNAPSHOT);
+    ByteWriter writer(out);
+    writer.putU32(header.tick);
+    writer.putU32(header.baselineTick);
+    writer.putU32(static_cast<uint32_t>(header.originX));
+    writer.putU32(static_cast<uint32_t>(header.originY));
+    writer.putU32(header.score);
+    writer.putU8(header.alive ? 1 : 0);
+    writer.putU32(header.checksum);
+
+    size_t i = 0;
+    while (i < cellCount) {
+        if (view[i] == m_baseline[i]) {
+            size_t end = i + 1;
+            while (end < cellCount && view[end] == m_baseline[end]) ++end;
+            if (end == cellCount) break; // Trailing unchanged cells need no token
+            for (; end - i > MAX_SKIP; i += MAX_SKIP) out.push_back(static_cast<uint8_t>(SKIP_TOKEN | (MAX_SKIP - 1)));
+            out.push_back(static_cast<uint8_t>(SKIP_TOKEN | (end - i - 1)));
+            i = end;
+        } else {
+            const uint8_t code = view[i];
+            size_t end = i + 1;
+            while (end < cellCount && end - i < MAX_RUN && view[end] == code) ++end;
+            out.push_back(static_cast<uint8_t>(((end - i - 1) << 3) | code));
+            i = end;
+        }
+    }
+
+    SnapshotView& sent = m_sent[header.tick % NET_SNAPSHOT_HISTORY];
+    sent.tick = header.tick;
+    sent.originX = header.originX;
+    sent.originY = header.originY;
+    sent.cells.assign(view, view + cellCount);
+    return header.baselineTick == NET_NO_TICK;
+}
+
+
+SnapshotDecoder::SnapshotDecoder(int viewRadius)
+    : m_side(2 * std::min(std::max(viewRadius, 0), NET_MAX_VIEW_RADIUS) + 1),
+      m_received(NET_SNAPSHOT_HISTORY),
+      m_latestHeader(),
+      m_scratch(static_cast<size_t>(m_side) * m_side) {
+    m_latest.cells.assign(m_scratch.size(), static_cast<uint8_t>(ViewCell::EMPTY));
+}
+
+void SnapshotDecoder::reset() {
+    for (SnapshotView& view : m_received) view.tick = NET_NO_TICK;
+    m_latest.tick = NET_NO_TICK;
+}
+
+bool SnapshotDecoder::apply(const uint8_t* data, size_t size) {
+    NetMessage message;
+    if (!readNetHeader(data, size, message) || message != NetMessage::SNAPSHOT) return false;
+    ByteReader reader(data + 3, size - 3);
+    SnapshotHeader header;
+    uint32_t originX, originY;
+    uint8_t flags;
+    if (!reader.getU32(header.tick) || !reader.getU32(header.baselineTick) || !reader.getU32(originX) ||
+        !reader.getU32(originY) || !reader.getU32(header.score) || !reader.getU8(flags) || !reader.getU32(header.checksum)) {
+        return false;
+    }
+    if (header.tick == NET_NO_TICK) return false;
+    header.originX = static_cast<int32_t>(originX);
+    header.originY = static_cast<int32_t>(originY);
+    header.alive = (flags & 1) != 0;
+
+    if (header.baselineTick == NET_NO_TICK) {
+        std::fill(m_scratch.begin(), m_scratch.end(), static_cast<uint8_t>(ViewCell::EMPTY));
+        m_keyframeCount++;
+    } else {
+        const SnapshotView& baseline = m_received[header.baselineTick % NET_SNAPSHOT_HISTORY];
+        if (baseline.tick != header.baselineTick) {
+            m_missingBaselineCount++;
+            return false;
+        }
+        moveView(baseline, m_side, header.originX, header.originY, m_scratch);
+    }
+
+    const uint8_t* token = data + 3 + reader.getPosition();
+    const uint8_t* end = data + size;
+    size_t cell = 0;
+    for (; token < end; ++token) {
+        size_t count;
+        if (*token & SKIP_TOKEN) {
+            count = (*token & (SKIP_TOKEN - 1)) + 1;
+        } else {
+            count = (*token >> 3) + 1;
+            if (cell + count > m_scratch.size()) return false;
+            std::memset(&m_scratch[cell], *token & 7, count);
+        }
+        cell += count;
+        if (cell > m_scratch.size()) return false;
+    }
+    if (viewChecksum(m_scratch.data(), m_scratch.size()) != header.checksum) {
+        m_checksumFailureCount++;
+        return false;
+    }
+
+    SnapshotView& received = m_received[header.tick % NET_SNAPSHOT_HISTORY];
+    received.tick = header.tick;
+    received.originX = header.originX;
+    received.originY = header.originY;
+    received.cells = m_scratch;
+    if (m_latest.tick == NET_NO_TICK || header.tick > m_latest.tick) {
+        m_latest = received;
+        m_latestHeader = header;
+    }
+    return true;
+}
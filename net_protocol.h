@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "game_sim.h"
+
+
+// Datagram protocol between snake_server and its clients. Every packet starts with
+// u16 NET_MAGIC and a u8 NetMessage; fields are little-endian (byte_io.h).
+//
+//   CONNECT    client -> server  u8 NET_PROTOCOL_VERSION
+//   WELCOME    server -> client  u32 slot, u16 width, u16 height, u8 view radius, u32 tick micros
+//   REJECT     server -> client  u8 NetRejectReason
+//   INPUT      client -> server  u32 acknowledged snapshot tick (NET_NO_TICK for none), u8 Direction
+//   SNAPSHOT   server -> client  u32 tick, u32 baseline tick (NET_NO_TICK: keyframe), i32 origin x,
+//                                i32 origin y, u32 score, u8 flags (bit 0: alive), u32 view checksum,
+//                                then the delta tokens up to the end of the datagram
+//   DISCONNECT client -> server  (nothing)
+//
+// A snapshot shows the (2r + 1) x (2r + 1) cells around the client's head as ViewCell codes
+// and is coded against the newest snapshot the client acknowledged (a keyframe against an
+// all-empty view), so a quiet tick costs a few bytes. Tokens walk the view row-major:
+//   1ttttttt   the next t + 1 cells did not change (1..128)
+//   0nnnnccc   the next n + 1 cells (1..16) all become code c
+// Cells after the last token did not change. Each cell costs at most one byte, so a view
+// of radius NET_MAX_VIEW_RADIUS always fits in NET_MAX_PACKET_SIZE.
+const uint16_t NET_MAGIC = 0x4E53; // "SN"
+const uint8_t NET_PROTOCOL_VERSION = 1;
+const uint32_t NET_NO_TICK = 0xFFFFFFFFu;
+const int NET_MAX_VIEW_RADIUS = 16;
+const size_t NET_SNAPSHOT_HEADER_SIZE = 28; // Magic, message and the SNAPSHOT fields before the tokens
+const size_t NET_MAX_PACKET_SIZE = NET_SNAPSHOT_HEADER_SIZE + (2 * NET_MAX_VIEW_RADIUS + 1) * (2 * NET_MAX_VIEW_RADIUS + 1);
+const size_t NET_SNAPSHOT_HISTORY = 32; // Snapshots either side keeps as possible baselines
+
+enum class NetMessage : uint8_t { CONNECT = 1, WELCOME, REJECT, INPUT, SNAPSHOT, DISCONNECT };
+enum class NetRejectReason : uint8_t { FULL, VERSION };
+
+// What a client sees in one cell of its view; fits the 3-bit code of a run token.
+enum class ViewCell : uint8_t { EMPTY, FOOD, BLOCKED, OWN_BODY, OWN_HEAD, OTHER_BODY, OTHER_HEAD };
+
+
+struct SnapshotHeader {
+    uint32_t tick;
+    uint32_t baselineTick;
+    int32_t originX; // Board cell of the view's top-left corner; may lie off the board
+    int32_t originY;
+    uint32_t score;
+    bool alive;
+    uint32_t checksum; // viewChecksum() of the full view after applying the delta
+};
+
+// One view as a client holds it: cells row-major, side x side.
+struct SnapshotView {
+    uint32_t tick = NET_NO_TICK;
+    int32_t originX = 0;
+    int32_t originY = 0;
+    std::vector<uint8_t> cells;
+};
+
+uint32_t viewChecksum(const uint8_t* cells, size_t count);
+
+void writeNetHeader(std::vector<uint8_t>& out, NetMessage message);
+// Checks the magic and returns the message type, or false for foreign datagrams.
+bool readNetHeader(const uint8_t* data, size_t size, NetMessage& message);
+
+
+// Server side, one per client: remembers the views sent in the last NET_SNAPSHOT_HISTORY
+// ticks and codes each new one against the one the client acknowledged. When that one is
+// unknown (never acknowledged, or older than the history) it sends a keyframe.
+class SnapshotEncoder {
+public:
+    explicit SnapshotEncoder(int viewRadius = NET_MAX_VIEW_RADIUS);
+
+    void reset();
+
+    // Appends a whole SNAPSHOT packet for view (getViewSide()^2 ViewCell codes) to out.
+    // header.baselineTick and header.checksum are filled in here. Returns true for a keyframe.
+    bool encode(SnapshotHeader header, const uint8_t* view, uint32_t ackedTick, std::vector<uint8_t>& out);
+
+    int getViewSide() const { return m_side; }
+
+private:
+    int m_side;
+    std::vector<SnapshotView> m_sent; // Ring indexed by tick % NET_SNAPSHOT_HISTORY
+    std::vector<uint8_t> m_baseline;  // Scratch: the acknowledged view moved to the new origin
+};
+
+
+// Client side: rebuilds views from SNAPSHOT packets and tracks which tick to acknowledge.
+class SnapshotDecoder {
+public:
+    explicit SnapshotDecoder(int viewRadius = NET_MAX_VIEW_RADIUS);
+
+    void reset();
+
+    // Decodes a SNAPSHOT packet (header included). False when it is malformed, its baseline
+    // is no longer held, or the rebuilt view fails the checksum; the packet is then dropped
+    // and the client keeps acknowledging the tick it has.
+    bool apply(const uint8_t* data, size_t size);
+
+    const SnapshotView& getLatest() const { return m_latest; }
+    const SnapshotHeader& getLatestHeader() const { return m_latestHeader; }
+    uint32_t getAckTick() const { return m_latest.tick; }
+    int getViewSide() const { return m_side; }
+
+    uint64_t getKeyframeCount() const { return m_keyframeCount; }
+    uint64_t getMissingBaselineCount() const { return m_missingBaselineCount; }
+    uint64_t getChecksumFailureCount() const { return m_checksumFailureCount; }
+
+private:
+    int m_side;
+    std::vector<SnapshotView> m_received; // Ring indexed by tick % NET_SNAPSHOT_HISTORY
+    SnapshotView m_latest;
+    SnapshotHeader m_latestHeader;
+    std::vector<uint8_t> m_scratch;
+    uint64_t m_keyframeCount = 0;
+    uint64_t m_missingBaselineCount = 0;
+    uint64_t m_checksumFailureCount = 0;
+};
@@ -0,0 +1,184 @@
+#include "observation_encoder.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+
+namespace {
+
+bool isBlocked(const GameSim& sim, int x, int y) {
+    return x < sim.getLeftSpikeWall() || x >= sim.getRightSpikeWall() || y < sim.getTopSpikeWall() ||
+           y >= sim.getBottomSpikeWall();
+}
+
+}
+
+
+ObservationEncoder::ObservationEncoder(int width, int height, ObservationFormat format, int cropRadius)
+    : m_width(width),
+      m_height(height),
+      m_format(format),
+      m_cropRadius(cropRadius),
+      m_viewWidth(cropRadius > 0 ? 2 * cropRadius + 1 : width),
+      m_viewHeight(cropRadius > 0 ? 2 * cropRadius + 1 : height),
+      m_head{-1, -1},
+      m_tail{-1, -1},
+      m_food{-1, -1},
+      m_length(0),
+      m_walls{0, 0, 0, 0} {
+    const size_t cells = static_cast<size_t>(m_viewWidth) * m_viewHeight;
+    m_planeSize = format == ObservationFormat::BIT_PLANES ? (cells + 7) / 8 : cells;
+}
+
+void ObservationEncoder::setCell(uint8_t* out, ObservationPlane plane, size_t cell, bool value) const {
+    uint8_t* planeData = out + static_cast<size_t>(plane) * m_planeSize;
+    if (m_format == ObservationFormat::CHANNELS) {
+        planeData[cell] = value ? 1 : 0;
+    } else if (value) {
+        planeData[cell >> 3] |= static_cast<uint8_t>(1u << (cell & 7));
+    } else {
+        planeData[cell >> 3] &= static_cast<uint8_t>(~(1u << (cell & 7)));
+    }
+}
+
+void ObservationEncoder::setRun(uint8_t* out, ObservationPlane plane, size_t cell, int count) const {
+    if (count <= 0) return;
+    if (m_format == ObservationFormat::CHANNELS) {
+        std::memset(out + static_cast<size_t>(plane) * m_planeSize + cell, 1, static_cast<size_t>(count));
+        return;
+    }
+    for (size_t end = cell + count; cell < end; ++cell) setCell(out, plane, cell, true);
+}
+
+void ObservationEncoder::setPoint(uint8_t* out, ObservationPlane plane, Point p, bool value) const {
+    setCell(out, plane, static_cast<size_t>(p.y) * m_width + p.x, value);
+}
+
+void ObservationEncoder::refreshBlocked(const GameSim& sim, uint8_t* out, int x0, int y0, int x1, int y1) const {
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) setPoint(out, ObservationPlane::BLOCKED, {x, y}, isBlocked(sim, x, y));
+    }
+}
+
+void ObservationEncoder::begin(const GameSim& sim, uint8_t* out) {
+    remember(sim);
+    if (m_cropRadius > 0) {
+        writeWindow(sim, out);
+        return;
+    }
+
+    std::memset(out, 0, getSize());
+    refreshBlocked(sim, out, 0, 0, m_width, m_walls[2]);
+    refreshBlocked(sim, out, 0, m_walls[3], m_width, m_height);
+    refreshBlocked(sim, out, 0, m_walls[2], m_walls[0], m_walls[3]);
+    refreshBlocked(sim, out, m_walls[1], m_walls[2], m_width, m_walls[3]);
+    for (const Point& p : sim.getSnake()) setPoint(out, ObservationPlane::BODY, p, true);
+    setPoint(out, ObservationPlane::HEAD, m_head, true);
+    setPoint(out, ObservationPlane::TAIL, m_tail, true);
+    if (m_food.x >= 0) setPoint(out, ObservationPlane::FOOD, m_food, true);
+}
+
+void ObservationEncoder::update(const GameSim& sim, uint8_t* out) {
+    if (m_cropRadius > 0) {
+        remember(sim);
+        writeWindow(sim, out);
+        return;
+    }
+
+    // One step either leaves the snake where it was or moves the head to a neighbour, growing
+    // by at most one cell; anything else (a reset, skipped steps) needs a full rewrite
+    const Point head = sim.getSnake().front();
+    const Point tail = sim.getSnake().back();
+    const size_t length = sim.getSnake().size();
+    const bool stayed = head == m_head && length == m_length;
+    const bool stepped = std::abs(head.x - m_head.x) + std::abs(head.y - m_head.y) == 1 &&
+                         (length == m_length || length == m_length + 1);
+    if (!stayed && !stepped) {
+        begin(sim, out);
+        return;
+    }
+
+    if (stepped) {
+        setPoint(out, ObservationPlane::HEAD, m_head, false);
+        setPoint(out, ObservationPlane::HEAD, head, true);
+        setPoint(out, ObservationPlane::BODY, head, true);
+    }
+    if (!(tail == m_tail)) {
+        setPoint(out, ObservationPlane::TAIL, m_tail, false);
+        setPoint(out, ObservationPlane::TAIL, tail, true);
+        if (length == m_length) setPoint(out, ObservationPlane::BODY, m_tail, false); // Tail moved off it
+    }
+
+    const Point food = sim.getFood();
+    if (!(food == m_food)) {
+        if (m_food.x >= 0) setPoint(out, ObservationPlane::FOOD, m_food, false);
+        if (food.x >= 0) setPoint(out, ObservationPlane::FOOD, food, true);
+    }
+
+    // Walls advance or snap back: recompute the bands between the old and new positions
+    const int walls[4] = {sim.getLeftSpikeWall(), sim.getRightSpikeWall(), sim.getTopSpikeWall(),
+                          sim.getBottomSpikeWall()};
+    for (int side = 0; side < 4; ++side) {
+        if (walls[side] == m_walls[side]) continue;
+        const int from = std::min(walls[side], m_walls[side]);
+        const int to = std::max(walls[side], m_walls[side]);
+        if (side < 2) refreshBlocked(sim, out, from, 0, to, m_height); // Left or right: columns
+        else refreshBlocked(sim, out, 0, from, m_width, to);           // Top or bottom: rows
+    }
+
+    remember(sim);
+}
+
+void ObservationEncoder::writeWindow(const GameSim& sim, uint8_t* out) const {
+    std::memset(out, 0, getSize());
+    const Bitboard& occupied = sim.getOccupancy();
+    const int left = m_head.x - m_cropRadius;
+    const int top = m_head.y - m_cropRadius;
+    // Open part of the window: inside the spike walls, which never lie outside the board
+    const int openLeft = std::max(sim.getLeftSpikeWall(), left) - left;
+    const int openRight = std::min(sim.getRightSpikeWall(), left + m_viewWidth) - left;
+    const int openTop = sim.getTopSpikeWall();
+    const int openBottom = sim.getBottomSpikeWall();
+
+    const int boardLeft = std::max(0, left) - left;
+    const int boardRight = std::min(m_width, left + m_viewWidth) - left;
+    for (int row = 0; row < m_viewHeight; ++row) {
+        const int y = top + row;
+        const size_t rowCell = static_cast<size_t>(row) * m_viewWidth;
+        if (y < openTop || y >= openBottom || openLeft >= openRight) {
+            setRun(out, ObservationPlane::BLOCKED, rowCell, m_viewWidth);
+        } else {
+            setRun(out, ObservationPlane::BLOCKED, rowCell, openLeft);
+            setRun(out, ObservationPlane::BLOCKED, rowCell + openRight, m_viewWidth - openRight);
+        }
+        if (y < 0 || y >= m_height) continue;
+
+        // Body cells of the row straight from the occupancy words, up to 64 at a time
+        for (int column = boardLeft; column < boardRight; column += 64) {
+            uint64_t bits = occupied.getBits(occupied.cellIndex(left + column, y), std::min(64, boardRight - column));
+            for (size_t cell = rowCell + column; bits != 0; bits >>= 1, ++cell) {
+                if (bits & 1) setCell(out, ObservationPlane::BODY, cell, true);
+            }
+        }
+    }
+
+    auto inWindow = [&](Point p) {
+        return p.x >= left && p.x < left + m_viewWidth && p.y >= top && p.y < top + m_viewHeight;
+    };
+    auto windowCell = [&](Point p) { return static_cast<size_t>(p.y - top) * m_viewWidth + (p.x - left); };
+    setCell(out, ObservationPlane::HEAD, windowCell(m_head), true);
+    if (inWindow(m_tail)) setCell(out, ObservationPlane::TAIL, windowCell(m_tail), true);
+    if (m_food.x >= 0 && inWindow(m_food)) setCell(out, ObservationPlane::FOOD, windowCell(m_food), true);
+}
+
+void ObservationEncoder::remember(const GameSim& sim) {
+    m_head = sim.getSnake().front();
+    m_tail = sim.getSnake().back();
+    m_food = sim.getFood();
+    m_length = sim.getSnake().size();
+    m_walls[0] = sim.getLeftSpikeWall();
+    m_walls[1] = sim.getRightSpikeWall();
+    m_walls[2] = sim.getTopSpikeWall();
+    m_walls[3] = sim.getBottomSpikeWall();
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "game_sim.h"
+
+
+// Planes of an observation, in buffer order. BODY covers every snake cell, head and tail
+// included; BLOCKED marks spike-covered cells and, in a cropped view, cells off the board.
+enum class ObservationPlane { HEAD, BODY, TAIL, FOOD, BLOCKED, COUNT };
+
+enum class ObservationFormat {
+    CHANNELS,  // One byte (0 or 1) per cell and plane
+    BIT_PLANES // One bit per cell and plane, cell c at byte c / 8, bit c % 8; planes start on a byte
+};
+
+
+// Writes a GameSim's state as planes (see ObservationPlane) into a caller-owned buffer of
+// getSize() bytes: plane-major, each plane row-major over the view. The view is the whole
+// board, or with a crop radius r a (2r + 1) x (2r + 1) window centred on the head, which
+// keeps the size fixed on large boards.
+//
+// begin() writes everything; update() after each step() rewrites only what the step changed
+// (head, tail, food, the spike bands that moved), so a whole-board view costs O(1) per tick
+// instead of O(cells). update() relies on the buffer still holding the previous result and
+// falls back to begin() when the snake did not move the way one step can. A cropped view
+// moves with the head, so update() redraws its window.
+class ObservationEncoder {
+public:
+    ObservationEncoder(int width, int height, ObservationFormat format, int cropRadius = 0);
+
+    size_t getSize() const { return m_planeSize * static_cast<size_t>(ObservationPlane::COUNT); }
+    size_t getPlaneSize() const { return m_planeSize; } // Bytes
+    int getViewWidth() const { return m_viewWidth; }
+    int getViewHeight() const { return m_viewHeight; }
+
+    void begin(const GameSim& sim, uint8_t* out);
+    void update(const GameSim& sim, uint8_t* out);
+
+private:
+    void setCell(uint8_t* out, ObservationPlane plane, size_t cell, bool value) const;
+    void setRun(uint8_t* out, ObservationPlane plane, size_t cell, int count) const; // Sets count cells from cell
+    void setPoint(uint8_t* out, ObservationPlane plane, Point p, bool value) const;
+    // Recomputes BLOCKED over the board rectangle [x0, x1) x [y0, y1) of a whole-board view
+    void refreshBlocked(const GameSim& sim, uint8_t* out, int x0, int y0, int x1, int y1) const;
+    void writeWindow(const GameSim& sim, uint8_t* out) const;
+    void remember(const GameSim& sim);
+
+    int m_width;
+    int m_height;
+    ObservationFormat m_format;
+    int m_cropRadius;
+    int m_viewWidth;
+    int m_viewHeight;
+    size_t m_planeSize;
+
+    // State the buffer shows, for update()
+    Point m_head;
+    Point m_tail;
+    Point m_food;
+    size_t m_length;
+    int m_walls[4]; // Left, right, top, bottom
+};
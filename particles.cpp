@@ -0,0 +1,80 @@
+#include "particles.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+ParticlePool::ParticlePool(size_t capacity)
+    : m_posX(capacity), m_posY(capacity), m_velX(capacity), m_velY(capacity),
+      m_lifetime(capacity), m_invInitialLifetime(capacity), m_color(capacity), m_count(0) {
+}
+
+bool ParticlePool::spawn(float x, float y, float velX, float velY, float lifetime, uint32_t color) {
+    if (m_count == m_posX.size()) return false;
+    size_t i = m_count++;
+    m_posX[i] = x;
+    m_posY[i] = y;
+    m_velX[i] = velX;
+    m_velY[i] = velY;
+    m_lifetime[i] = lifetime;
+    m_invInitialLifetime[i] = 1.f / lifetime;
+    m_color[i] = color;
+    return true;
+}
+
+size_t ParticlePool::spawnBurst(float x, float y, size_t count, float minSpeed, float maxSpeed, float minLifetime,
+                                float maxLifetime, uint32_t color, Rng& rng) {
+    count = std::min(count, m_posX.size() - m_count);
+    const size_t first = m_count;
+    // Angles and speeds go into the velocity arrays first and are turned into vectors below
+    float* angle = &m_velX[first];
+    float* speed = &m_velY[first];
+    rng.fillRange(angle, count, 0.f, 6.2831853f);
+    rng.fillRange(speed, count, minSpeed, maxSpeed);
+    rng.fillRange(&m_lifetime[first], count, minLifetime, maxLifetime);
+    for (size_t i = 0; i < count; ++i) {
+        const float a = angle[i];
+        const float s = speed[i];
+        angle[i] = std::cos(a) * s;
+        speed[i] = std::sin(a) * s;
+        m_posX[first + i] = x;
+        m_posY[first + i] = y;
+        m_invInitialLifetime[first + i] = 1.f / m_lifetime[first + i];
+        m_color[first + i] = color;
+    }
+    m_count += count;
+    return count;
+}
+
+void ParticlePool::update(float dt) {
+    const size_t n = m_count;
+    float* __restrict posX = m_posX.data();
+    float* __restrict posY = m_posY.data();
+    const float* __restrict velX = m_velX.data();
+    const float* __restrict velY = m_velY.data();
+    float* __restrict lifetime = m_lifetime.data();
+
+    // Branch-free integration, the compiler turns this into packed SIMD
+    for (size_t i = 0; i < n; ++i) {
+        posX[i] += velX[i] * dt;
+        posY[i] += velY[i] * dt;
+        lifetime[i] -= dt;
+    }
+
+    // Swap-and-pop removal of expired particles
+    size_t i = 0;
+    while (i < m_count) {
+        if (m_lifetime[i] > 0.f) {
+            ++i;
+            continue;
+        }
+        size_t last = --m_count;
+        m_posX[i] = m_posX[last];
+        m_posY[i] = m_posY[last];
+        m_velX[i] = m_velX[last];
+        m_velY[i] = m_velY[last];
+        m_lifetime[i] = m_lifetime[last];
+        m_invInitialLifetime[i] = m_invInitialLifetime[last];
+        m_color[i] = m_color[last];
+    }
+}
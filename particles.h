@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "rng.h"
+
+
+// Fixed-capacity particle pool in structure-of-arrays layout. Storage is allocated once;
+// dead particles are removed with swap-and-pop, so the live range is always [0, size()).
+class ParticlePool {
+public:
+    explicit ParticlePool(size_t capacity);
+
+    void clear() { m_count = 0; }
+
+    // Adds one particle; returns false (and drops it) when the pool is full.
+    // color is packed as 0xRRGGBB, alpha follows the remaining lifetime.
+    bool spawn(float x, float y, float velX, float velY, float lifetime, uint32_t color);
+
+    // Adds up to count particles at (x, y) flying in random directions with random speed and
+    // lifetime from the given ranges. The random values are generated in one batch straight
+    // into the pool's arrays. Returns how many fit.
+    size_t spawnBurst(float x, float y, size_t count, float minSpeed, float maxSpeed, float minLifetime,
+                      float maxLifetime, uint32_t color, Rng& rng);
+
+    // Integrates positions and lifetimes, then removes expired particles.
+    void update(float dt);
+
+    size_t size() const { return m_count; }
+    size_t capacity() const { return m_posX.size(); }
+
+    const float* getPosX() const { return m_posX.data(); }
+    const float* getPosY() const { return m_posY.data(); }
+    const uint32_t* getColor() const { return m_color.data(); }
+
+    // Remaining lifetime fraction in [0, 1] of particle i.
+    float getLifeFraction(size_t i) const { return m_lifetime[i] * m_invInitialLifetime[i]; }
+
+private:
+    std::vector<float> m_posX;
+    std::vector<float> m_posY;
+    std::vector<float> m_velX;
+    std::vector<float> m_velY;
+    std::vector<float> m_lifetime;
+    std::vector<float> m_invInitialLifetime;
+    std::vector<uint32_t> m_color;
+    size_t m_count;
+};
@@ -0,0 +1,81 @@
+#include "profiler_overlay.h"
+
+#include <algorithm>
+#include <cstdio>
+
+
+namespace {
+
+const float GRAPH_WIDTH = 240.f;         // One pixel per frame of history
+const float GRAPH_HEIGHT = 80.f;
+const float GRAPH_MAX_MS = 40.f;         // Frames slower than this are clipped
+const float PADDING = 6.f;
+const float TEXT_HEIGHT = 150.f;
+const float TEXT_REFRESH_SECONDS = 0.25f;
+const float BUDGET_60_MS = 1000.f / 60.f;
+const float BUDGET_30_MS = 1000.f / 30.f;
+
+void appendRect(sf::VertexArray& quads, float left, float top, float width, float height, const sf::Color& color) {
+    quads.append(sf::Vertex(sf::Vector2f(left, top), color));
+    quads.append(sf::Vertex(sf::Vector2f(left + width, top), color));
+    quads.append(sf::Vertex(sf::Vector2f(left + width, top + height), color));
+    quads.append(sf::Vertex(sf::Vector2f(left, top + height), color));
+}
+
+}
+
+
+ProfilerOverlay::ProfilerOverlay(const sf::Font& font)
+    : m_background(sf::Quads), m_graph(sf::Quads), m_textRefreshTimer(0.f) {
+    m_text.setFont(font);
+    m_text.setCharacterSize(12);
+    m_text.setFillColor(sf::Color::White);
+    m_text.setPosition(PADDING, PADDING);
+    appendRect(m_background, 0.f, 0.f, getWidth(), TEXT_HEIGHT + GRAPH_HEIGHT + 3.f * PADDING, sf::Color(0, 0, 0, 180));
+}
+
+float ProfilerOverlay::getWidth() const {
+    return GRAPH_WIDTH + 2.f * PADDING;
+}
+
+void ProfilerOverlay::update(const FrameProfiler& profiler, const std::string& counters, float dt) {
+    // Graph: bars bottom-aligned, newest on the right, plus the 60 fps budget line
+    const float graphTop = TEXT_HEIGHT + 2.f * PADDING;
+    const float scale = GRAPH_HEIGHT / GRAPH_MAX_MS;
+    m_graph.clear();
+    size_t frames = profiler.getHistorySize();
+    float left = PADDING + GRAPH_WIDTH - static_cast<float>(frames);
+    for (size_t i = 0; i < frames; ++i) {
+        float ms = profiler.getFrameMs(i);
+        float height = std::min(ms, GRAPH_MAX_MS) * scale;
+        sf::Color color = ms <= BUDGET_60_MS ? sf::Color(0, 200, 0) : ms <= BUDGET_30_MS ? sf::Color(230, 200, 0) : sf::Color(230, 40, 40);
+        appendRect(m_graph, left + i, graphTop + GRAPH_HEIGHT - height, 1.f, height, color);
+    }
+    appendRect(m_graph, PADDING, graphTop + GRAPH_HEIGHT - BUDGET_60_MS * scale, GRAPH_WIDTH, 1.f, sf::Color(255, 255, 255, 120));
+
+    m_textRefreshTimer -= dt;
+    if (m_textRefreshTimer > 0.f) return;
+    m_textRefreshTimer = TEXT_REFRESH_SECONDS;
+
+    FrameStats stats = profiler.computeStats();
+    char line[128];
+    std::string text;
+    std::snprintf(line, sizeof(line), "frame ms  p50 %.2f  p99 %.2f  max %.2f\n", stats.p50Ms, stats.p99Ms, stats.maxMs);
+    text += line;
+    for (size_t phase = 0; phase < static_cast<size_t>(FramePhase::COUNT); ++phase) {
+        std::snprintf(line, sizeof(line), "  %-8s %6.3f ms\n", getFramePhaseName(static_cast<FramePhase>(phase)),
+                      stats.phaseAverageMs[phase]);
+        text += line;
+    }
+    std::snprintf(line, sizeof(line), "draw calls: %u\n", stats.drawCalls);
+    text += line;
+    text += counters;
+    m_text.setString(text);
+}
+
+void ProfilerOverlay::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    states.transform.translate(m_position.x, m_position.y);
+    target.draw(m_background, states);
+    target.draw(m_graph, states);
+    target.draw(m_text, states);
+}
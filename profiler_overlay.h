@@ -0,0 +1,33 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <string>
+
+#include "frame_profiler.h"
+
+
+// On-screen view of a FrameProfiler: rolling frame-time graph (one bar per frame, green under
+// 60 fps budget, yellow under 30 fps, red above), p50/p99/max, per-phase averages, the last
+// frame's draw calls and caller-supplied counter lines. The graph is refreshed every frame, the
+// text a few times per second so it stays readable.
+class ProfilerOverlay : public sf::Drawable {
+public:
+    explicit ProfilerOverlay(const sf::Font& font);
+
+    void setPosition(float x, float y) { m_position = sf::Vector2f(x, y); }
+    float getWidth() const;
+
+    void update(const FrameProfiler& profiler, const std::string& counters, float dt);
+
+    // Draw calls one draw() issues (background, graph, text); they count towards the frame.
+    unsigned getDrawCallCount() const { return 3; }
+
+private:
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+    sf::Vector2f m_position;
+    sf::Text m_text;
+    sf::VertexArray m_background;
+    sf::VertexArray m_graph;
+    float m_textRefreshTimer;
+};
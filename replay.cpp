@@ -0,0 +1,132 @@
+#include "replay.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#include "byte_io.h"
+
+
+namespace {
+
+const uint8_t REPLAY_MAGIC[4] = {'S', 'N', 'K', 'R'};
+const uint8_t REPLAY_VERSION = 4; // 2: integer-microsecond tick timing, 3: xoshiro food stream, 4: flags
+const uint8_t FLAG_SPIKES_OFF = 1;
+
+}
+
+
+std::vector<uint8_t> Replay::encode() const {
+    std::vector<uint8_t> bytes;
+    ByteWriter out(bytes);
+    out.putBytes(REPLAY_MAGIC, sizeof(REPLAY_MAGIC));
+    out.putU8(REPLAY_VERSION);
+    out.putU16(width);
+    out.putU16(height);
+    out.putU32(seed);
+    out.putU8(spikesEnabled ? 0 : FLAG_SPIKES_OFF);
+    out.putVarint(tickCount);
+    out.putVarint(events.size());
+    out.putVarint(finalScore);
+    out.putU64(finalStateHash);
+
+    uint32_t previousTick = 0;
+    for (const ReplayEvent& event : events) {
+        out.putVarint((static_cast<uint64_t>(event.tick - previousTick) << 2) | static_cast<uint64_t>(event.direction));
+        previousTick = event.tick;
+    }
+    return bytes;
+}
+
+bool Replay::decode(const uint8_t* data, size_t size) {
+    ByteReader in(data, size);
+    uint8_t magic[4];
+    for (uint8_t& byte : magic) {
+        if (!in.getU8(byte)) return false;
+    }
+    if (!std::equal(magic, magic + 4, REPLAY_MAGIC)) return false;
+
+    uint8_t version, flags;
+    uint64_t ticks, eventCount, score;
+    if (!in.getU8(version) || version != REPLAY_VERSION) return false;
+    if (!in.getU16(width) || !in.getU16(height) || !in.getU32(seed)) return false;
+    if (!isValidBoardSize(width, height)) return false;
+    if (!in.getU8(flags) || (flags & ~FLAG_SPIKES_OFF) != 0) return false;
+    spikesEnabled = (flags & FLAG_SPIKES_OFF) == 0;
+    if (!in.getVarint(ticks) || !in.getVarint(eventCount) || !in.getVarint(score)) return false;
+    if (ticks > UINT32_MAX || score > UINT32_MAX) return false;
+    if (!in.getU64(finalStateHash)) return false;
+    if (eventCount > in.getRemaining()) return false; // Every event takes at least one byte
+    tickCount = static_cast<uint32_t>(ticks);
+    finalScore = static_cast<uint32_t>(score);
+
+    events.clear();
+    events.reserve(static_cast<size_t>(eventCount));
+    uint64_t tick = 0;
+    for (uint64_t i = 0; i < eventCount; ++i) {
+        uint64_t packed;
+        if (!in.getVarint(packed)) return false;
+        // The recorder writes at most one event per tick, so only the first may be at tick 0
+        if (i > 0 && (packed >> 2) == 0) return false;
+        tick += packed >> 2;
+        if (tick >= tickCount) return false;
+        events.push_back({static_cast<uint32_t>(tick), static_cast<Direction>(packed & 3)});
+    }
+    return true;
+}
+
+bool Replay::saveToFile(const std::string& path) const {
+    std::vector<uint8_t> bytes = encode();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(file);
+}
+
+bool Replay::loadFromFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return decode(bytes.data(), bytes.size());
+}
+
+
+void ReplayRecorder::begin(const GameSim& sim) {
+    m_replay = Replay();
+    m_replay.width = static_cast<uint16_t>(sim.getWidth());
+    m_replay.height = static_cast<uint16_t>(sim.getHeight());
+    m_replay.seed = sim.getSeed();
+    m_replay.spikesEnabled = sim.areSpikesEnabled();
+    m_lastDirection = sim.getDirection();
+}
+
+void ReplayRecorder::record(const GameSim& sim) {
+    if (sim.getDirection() != m_lastDirection) {
+        m_lastDirection = sim.getDirection();
+        m_replay.events.push_back({m_replay.tickCount, m_lastDirection});
+    }
+    m_replay.tickCount++;
+}
+
+const Replay& ReplayRecorder::finish(const GameSim& sim) {
+    m_replay.finalScore = static_cast<uint32_t>(sim.getScore());
+    m_replay.finalStateHash = sim.computeStateHash();
+    return m_replay;
+}
+
+
+void ReplayPlayer::start(GameSim& sim) {
+    sim.setSpikesEnabled(m_replay->spikesEnabled);
+    sim.reset(m_replay->seed);
+    m_tick = 0;
+    m_nextEvent = 0;
+}
+
+StepResult ReplayPlayer::step(GameSim& sim) {
+    Direction input = Direction::NONE;
+    const std::vector<ReplayEvent>& events = m_replay->events;
+    if (m_nextEvent < events.size() && events[m_nextEvent].tick == m_tick) {
+        input = events[m_nextEvent++].direction;
+    }
+    m_tick++;
+    return sim.step(input);
+}
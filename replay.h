@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "game_sim.h"
+
+
+// A direction change at a given tick (ticks count GameSim::step() calls from the reset).
+struct ReplayEvent {
+    uint32_t tick;
+    Direction direction;
+};
+
+// Everything needed to re-simulate a game bit for bit: the board, the seed passed to
+// GameSim::reset(), the rule options and the ticks at which the snake turned. The final score and state
+// hash are stored so playback can check it arrived at the same place.
+//
+// File layout (little-endian): "SNKR", u8 version, u16 width, u16 height, u32 seed,
+// u8 flags (bit 0: spikes off), varint tickCount, varint eventCount, varint finalScore, u64 finalStateHash, then per
+// event varint((tickDelta << 2) | direction), tickDelta counted from the previous event.
+struct Replay {
+    uint16_t width = DEFAULT_GRID_WIDTH;
+    uint16_t height = DEFAULT_GRID_HEIGHT;
+    uint32_t seed = 0;
+    bool spikesEnabled = true;
+    uint32_t tickCount = 0;
+    uint32_t finalScore = 0;
+    uint64_t finalStateHash = 0;
+    std::vector<ReplayEvent> events;
+
+    std::vector<uint8_t> encode() const;
+    bool decode(const uint8_t* data, size_t size);
+
+    bool saveToFile(const std::string& path) const;
+    bool loadFromFile(const std::string& path);
+};
+
+
+// Builds a Replay while a game is played: call begin() after GameSim::reset() and
+// record() after every GameSim::step().
+class ReplayRecorder {
+public:
+    void begin(const GameSim& sim);
+    void record(const GameSim& sim);
+    const Replay& finish(const GameSim& sim);
+
+    const Replay& getReplay() const { return m_replay; }
+
+private:
+    Replay m_replay;
+    Direction m_lastDirection = Direction::NONE;
+};
+
+
+// Feeds a Replay back into a GameSim one tick at a time.
+class ReplayPlayer {
+public:
+    explicit ReplayPlayer(const Replay* replay = nullptr) : m_replay(replay) {}
+
+    void setReplay(const Replay* replay) { m_replay = replay; }
+
+    // Resets sim to the recorded seed and rewinds to tick 0. sim must have been created with
+    // the replay's width and height.
+    void start(GameSim& sim);
+    StepResult step(GameSim& sim);
+
+    bool isFinished() const { return m_tick >= m_replay->tickCount; }
+    uint32_t getTick() const { return m_tick; }
+
+private:
+    const Replay* m_replay;
+    uint32_t m_tick = 0;
+    size_t m_nextEvent = 0;
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+
+// Fixed-capacity double-ended ring used for the snake body (index 0 is the head).
+// Storage is allocated once by reserve(); push_front/pop_back never allocate.
+// Capacity is rounded up to a power of two so wrapping is a mask.
+template <typename T>
+class RingBuffer {
+public:
+    // Contiguous run of elements in head-to-tail order.
+    struct Span {
+        const T* data;
+        size_t size;
+    };
+
+    class const_iterator {
+    public:
+        const_iterator(const RingBuffer* ring, size_t index) : m_ring(ring), m_index(index) {}
+        const T& operator*() const { return (*m_ring)[m_index]; }
+        const T* operator->() const { return &(*m_ring)[m_index]; }
+        const_iterator& operator++() { ++m_index; return *this; }
+        bool operator==(const const_iterator& other) const { return m_index == other.m_index; }
+        bool operator!=(const const_iterator& other) const { return m_index != other.m_index; }
+
+    private:
+        const RingBuffer* m_ring;
+        size_t m_index;
+    };
+
+    RingBuffer() : m_mask(0), m_head(0), m_size(0) {}
+    explicit RingBuffer(size_t capacity) : RingBuffer() { reserve(capacity); }
+
+    // Drops the contents and sets the capacity.
+    void reserve(size_t capacity) {
+        size_t rounded = 1;
+        while (rounded < capacity) rounded <<= 1;
+        m_data.assign(rounded, T());
+        m_mask = rounded - 1;
+        m_head = 0;
+        m_size = 0;
+    }
+
+    void clear() { m_head = 0; m_size = 0; }
+
+    // Replaces the contents with values[0..count), count <= capacity().
+    void assign(const T* values, size_t count) {
+        std::copy(values, values + count, m_data.begin());
+        m_head = 0;
+        m_size = count;
+    }
+
+    void push_front(const T& value) {
+        m_head = (m_head - 1) & m_mask;
+        m_data[m_head] = value;
+        ++m_size;
+    }
+
+    void pop_back() { --m_size; }
+
+    const T& front() const { return m_data[m_head]; }
+    const T& back() const { return m_data[(m_head + m_size - 1) & m_mask]; }
+    const T& operator[](size_t i) const { return m_data[(m_head + i) & m_mask]; }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    size_t capacity() const { return m_data.size(); }
+    bool full() const { return m_size == m_data.size(); }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_size); }
+
+    // The body split at the wrap point: firstSpan() starts at the head, secondSpan() holds the
+    // rest (empty when the body does not wrap).
+    Span firstSpan() const {
+        size_t n = std::min(m_size, m_data.size() - m_head);
+        return {m_data.data() + m_head, n};
+    }
+    Span secondSpan() const {
+        size_t n = m_size - firstSpan().size;
+        return {m_data.data(), n};
+    }
+
+    // Slot of element i in the underlying storage, stable while the element stays in the ring.
+    size_t slotOf(size_t i) const { return (m_head + i) & m_mask; }
+    T& atSlot(size_t slot) { return m_data[slot]; }
+
+private:
+    std::vector<T> m_data;
+    size_t m_mask;
+    size_t m_head;
+    size_t m_size;
+};
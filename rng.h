@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+
+// Purpose of a random stream. Each purpose of each game gets its own generator, so drawing
+// particles or shaking the camera never changes where the next food appears, and parallel
+// games never share state.
+enum class RngStream : uint32_t { FOOD, POLICY, PARTICLES, CAMERA_SHAKE, GAME_SEED };
+
+// SplitMix32-style mixing so neighbouring indices get unrelated seeds (e.g. games of a batch).
+inline uint32_t deriveSeed(uint32_t seed, uint32_t index) {
+    uint32_t z = seed + 0x9E3779B9u * (index + 1);
+    z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+    z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+    return z ^ (z >> 16);
+}
+
+
+// xoshiro128** generator: 16 bytes of state, a few shifts and multiplies per 32-bit value and
+// no global state. The same (seed, stream) pair always gives the same sequence on every
+// platform. Also usable as a standard UniformRandomBitGenerator.
+class Rng {
+public:
+    using result_type = uint32_t;
+
+    explicit Rng(uint64_t seed = 0, RngStream stream = RngStream::FOOD) { seedState(seed, stream); }
+
+    void seed(uint64_t seed, RngStream stream = RngStream::FOOD) { seedState(seed, stream); }
+
+    // Raw generator state, for save states. setState() with all-zero words is not allowed.
+    void getState(uint32_t out[4]) const { std::copy(m_state, m_state + 4, out); }
+    void setState(const uint32_t state[4]) { std::copy(state, state + 4, m_state); }
+
+    uint32_t next() {
+        const uint32_t result = rotl(m_state[1] * 5u, 7) * 9u;
+        const uint32_t t = m_state[1] << 9;
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = rotl(m_state[3], 11);
+        return result;
+    }
+
+    uint32_t operator()() { return next(); }
+    static constexpr uint32_t min() { return 0; }
+    static constexpr uint32_t max() { return UINT32_MAX; }
+
+    // Uniform integer in [0, bound), bound > 0. Multiply-shift with rejection (Lemire): unbiased,
+    // and the modulo is only computed in the rare case a value lands in the biased range.
+    uint32_t nextBelow(uint32_t bound) {
+        uint64_t product = static_cast<uint64_t>(next()) * bound;
+        uint32_t low = static_cast<uint32_t>(product);
+        if (low < bound) {
+            const uint32_t threshold = (0u - bound) % bound;
+            while (low < threshold) {
+                product = static_cast<uint64_t>(next()) * bound;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+
+    // Uniform float in [0, 1) from the top 24 bits, without a division.
+    float nextFloat() { return static_cast<float>(next() >> 8) * (1.f / 16777216.f); }
+
+    float nextRange(float min, float max) { return min + (max - min) * nextFloat(); }
+
+    // Fills out[0..count) with uniform floats in [min, max); cheaper than count separate calls
+    // for bursts such as particle spawns.
+    void fillRange(float* out, size_t count, float min, float max) {
+        const float scale = (max - min) * (1.f / 16777216.f);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = min + static_cast<float>(next() >> 8) * scale;
+        }
+    }
+
+private:
+    static uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+
+    static uint64_t splitMix64(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    void seedState(uint64_t seed, RngStream stream) {
+        uint64_t state = seed ^ (static_cast<uint64_t>(stream) << 56);
+        const uint64_t a = splitMix64(state);
+        const uint64_t b = splitMix64(state);
+        m_state[0] = static_cast<uint32_t>(a);
+        m_state[1] = static_cast<uint32_t>(a >> 32);
+        m_state[2] = static_cast<uint32_t>(b);
+        m_state[3] = static_cast<uint32_t>(b >> 32);
+        if ((m_state[0] | m_state[1] | m_state[2] | m_state[3]) == 0) m_state[0] = 1; // All-zero state is a fixed point
+    }
+
+    uint32_t m_state[4];
+};
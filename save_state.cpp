@@ -0,0 +1,80 @@
+#include "save_state.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+size_t getSaveStateSize(const GameSim& sim) {
+    return sizeof(SaveState) + sim.getSnake().size() * sizeof(Point) + sim.getFreeCells().getOrderSize() * sizeof(FreeCellSlot);
+}
+
+
+bool SaveStateFile::create(const std::string& path, int width, int height, const std::vector<size_t>& slotSizes) {
+    if (!isValidBoardSize(width, height) || slotSizes.empty()) return false;
+    // Slots start on 8 bytes, so their fields stay aligned in the mapping
+    std::vector<uint64_t> slotOffsets(slotSizes.size());
+    size_t size = sizeof(SaveFileHeader) + slotSizes.size() * sizeof(uint64_t);
+    for (size_t i = 0; i < slotSizes.size(); ++i) {
+        slotOffsets[i] = size;
+        size += (std::max(slotSizes[i], sizeof(SaveState)) + 7) & ~static_cast<size_t>(7);
+    }
+    if (!m_file.create(path, size)) return false;
+
+    SaveFileHeader fileHeader;
+    fileHeader.magic = SAVE_FILE_MAGIC;
+    fileHeader.version = SAVE_FILE_VERSION;
+    fileHeader.width = width;
+    fileHeader.height = height;
+    fileHeader.slotCount = slotSizes.size();
+    std::memcpy(m_file.getData(), &fileHeader, sizeof(fileHeader));
+    std::memcpy(m_file.getData() + sizeof(fileHeader), slotOffsets.data(), slotOffsets.size() * sizeof(uint64_t));
+    return true;
+}
+
+bool SaveStateFile::open(const std::string& path, bool writable) {
+    if (!m_file.open(path, writable)) return false;
+    const uint64_t size = m_file.getSize();
+    bool valid = size >= sizeof(SaveFileHeader);
+    if (valid) {
+        const SaveFileHeader& fileHeader = header();
+        valid = fileHeader.magic == SAVE_FILE_MAGIC && fileHeader.version == SAVE_FILE_VERSION &&
+                isValidBoardSize(fileHeader.width, fileHeader.height) && fileHeader.slotCount > 0 &&
+                fileHeader.slotCount <= (size - sizeof(SaveFileHeader)) / sizeof(uint64_t);
+    }
+    // Every slot has to hold at least a SaveState, start aligned and follow the previous one
+    uint64_t end = valid ? sizeof(SaveFileHeader) + header().slotCount * sizeof(uint64_t) : 0;
+    for (size_t i = 0; valid && i < getSlotCount(); ++i) {
+        const uint64_t offset = offsets()[i];
+        valid = offset >= end && offset % 8 == 0 && offset <= size && size - offset >= sizeof(SaveState);
+        end = offset + sizeof(SaveState);
+    }
+    if (!valid) m_file.close();
+    return valid;
+}
+
+bool SaveStateFile::isSlotComplete(size_t i) const {
+    if (i >= getSlotCount()) return false;
+    const SaveState& state = getState(i);
+    const uint64_t arrays = (static_cast<uint64_t>(state.snakeLength) + state.orderSize) * 8;
+    return state.snakeLength != 0 && sizeof(SaveState) + arrays <= getSlotSize(i);
+}
+
+bool SaveStateFile::save(size_t i, const GameSim& sim, Direction queued) {
+    if (!m_file.isWritable() || i >= getSlotCount() || sim.getWidth() != getWidth() || sim.getHeight() != getHeight() ||
+        getSaveStateSize(sim) > getSlotSize(i)) {
+        return false;
+    }
+    SaveState& state = *reinterpret_cast<SaveState*>(slot(i));
+    sim.saveState(state);
+    state.queuedDirection = static_cast<int32_t>(queued);
+    return true;
+}
+
+bool SaveStateFile::load(size_t i, GameSim& sim, Direction* queued) const {
+    if (!isSlotComplete(i)) return false;
+    const SaveState& state = getState(i);
+    if (state.queuedDirection < 0 || state.queuedDirection > static_cast<int32_t>(Direction::NONE)) return false;
+    if (!sim.loadState(state)) return false;
+    if (queued) *queued = static_cast<Direction>(state.queuedDirection);
+    return true;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "game_sim.h"
+#include "mapped_file.h"
+
+
+const uint32_t SAVE_FILE_MAGIC = 0x544B4E53; // "SNKT" in file order
+const uint32_t SAVE_FILE_VERSION = 1;
+
+// SaveState::flags
+const uint32_t SAVE_STATE_ALIVE = 1;
+const uint32_t SAVE_STATE_SPIKES = 2;
+
+// Save states hold complete GameSim states in the layout they have in memory, so a file is
+// mapped and a state is loaded by copying its arrays back, with nothing to parse.
+//
+// Layout (little-endian, every field naturally aligned): a SaveFileHeader, slotCount u64
+// offsets of the slots from the start of the file, then the slots. A slot is a SaveState
+// followed by the body (snakeLength Point records, x and y as int32, head first) and the
+// orderSize slots of the free-cell index that moved (FreeCellSlot records). Food sampling
+// draws from that order, so a loaded game continues exactly like the one that was saved.
+//
+// A slot takes 96 bytes plus 8 per body segment and 8 per moved index slot, so saving and
+// loading cost the length of the game rather than the board area. The moved slots are the
+// cells the snake has visited since the game started, plus a few per food eaten, so a very
+// long game on a large board still approaches 8 bytes per cell.
+struct SaveFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    int32_t width;
+    int32_t height;
+    uint64_t slotCount;
+};
+
+struct SaveState {
+    int32_t width;
+    int32_t height;
+    uint32_t flags; // SAVE_STATE_*
+    uint32_t seed;
+    int32_t direction;
+    int32_t queuedDirection; // Move the player requested for the next tick
+    int32_t tickMicros;
+    int32_t score;
+    int32_t foodX;
+    int32_t foodY;
+    int32_t foodTimer;
+    int32_t spikeAdvanceTimer;
+    int32_t spikeWalls[4]; // Left, right, top, bottom
+    uint32_t rngState[4];  // Food generator
+    uint32_t snakeLength;
+    uint32_t freeCount;
+    uint32_t orderSize;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(SaveFileHeader) == 24, "SaveFileHeader must have no padding");
+static_assert(sizeof(SaveState) == 96, "SaveState must have no padding");
+static_assert(sizeof(Point) == 8 && sizeof(FreeCellSlot) == 8, "slot records are two 32-bit values");
+
+// Bytes sim's state takes in a slot.
+size_t getSaveStateSize(const GameSim& sim);
+
+inline const Point* getSaveStateBody(const SaveState* state) { return reinterpret_cast<const Point*>(state + 1); }
+inline Point* getSaveStateBody(SaveState* state) { return reinterpret_cast<Point*>(state + 1); }
+inline const FreeCellSlot* getSaveStateOrder(const SaveState* state) {
+    return reinterpret_cast<const FreeCellSlot*>(getSaveStateBody(state) + state->snakeLength);
+}
+inline FreeCellSlot* getSaveStateOrder(SaveState* state) {
+    return reinterpret_cast<FreeCellSlot*>(getSaveStateBody(state) + state->snakeLength);
+}
+
+
+// A mapped save state file. Batch tools create one slot per game, sized for it, and write
+// them straight into the mapping; the game uses a file of one slot. States can be read in
+// place through getState() without loading them into a GameSim.
+class SaveStateFile {
+public:
+    // Creates (or truncates) path with one empty slot per entry of slotSizes (bytes, e.g.
+    // getSaveStateSize()) for a width x height board, mapped read-write.
+    bool create(const std::string& path, int width, int height, const std::vector<size_t>& slotSizes);
+    // Maps an existing file; false unless the header and the slot table fit the file.
+    bool open(const std::string& path, bool writable = false);
+    void close() { m_file.close(); }
+    bool flush() { return m_file.flush(); }
+    bool isOpen() const { return m_file.isOpen(); }
+
+    int getWidth() const { return header().width; }
+    int getHeight() const { return header().height; }
+    size_t getSlotCount() const { return static_cast<size_t>(header().slotCount); }
+
+    // Slot i in place; check isSlotComplete() before reading the arrays of a file from elsewhere.
+    const SaveState& getState(size_t i) const { return *reinterpret_cast<const SaveState*>(slot(i)); }
+    bool isSlotComplete(size_t i) const; // Written, and its arrays lie inside the slot
+
+    // Stores sim and the queued move in slot i; false unless the file is writable, for sim's
+    // board, and the slot is large enough.
+    bool save(size_t i, const GameSim& sim, Direction queued = Direction::NONE);
+    // Loads slot i into sim (see GameSim::loadState()); queued receives the saved move.
+    bool load(size_t i, GameSim& sim, Direction* queued = nullptr) const;
+
+private:
+    const SaveFileHeader& header() const { return *reinterpret_cast<const SaveFileHeader*>(m_file.getData()); }
+    const uint64_t* offsets() const { return reinterpret_cast<const uint64_t*>(m_file.getData() + sizeof(SaveFileHeader)); }
+    uint8_t* slot(size_t i) const { return m_file.getData() + offsets()[i]; }
+    size_t getSlotSize(size_t i) const {
+        return static_cast<size_t>((i + 1 < getSlotCount() ? offsets()[i + 1] : m_file.getSize()) - offsets()[i]);
+    }
+
+    MappedFile m_file;
+};
@@ -0,0 +1,215 @@
+#include "snake_env.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "game_sim.h"
+#include "observation_encoder.h"
+#include "rng.h"
+#include "thread_pool.h"
+
+
+namespace {
+
+// Environments handed to a worker at a time when stepping on several threads
+const size_t ENV_CHUNK_SIZE = 64;
+
+struct EnvSlot {
+    GameSim sim;
+    Rng seedRng; // RngStream::GAME_SEED of the environment's seed, one draw per episode
+    bool over;   // Episode ended and was not restarted (no SNAKE_ENV_AUTO_RESET)
+};
+
+}
+
+
+struct SnakeEnv {
+    std::vector<EnvSlot> slots;
+    int width;
+    int height;
+    uint32_t flags;
+    std::unique_ptr<WorkStealingPool> pool; // Null when stepping on the calling thread
+    std::vector<ObservationEncoder> encoders; // One per slot; empty for SNAKE_ENV_OBS_CELLS
+    const uint8_t* lastObservations;          // Buffer the encoders last wrote, if still in sync
+
+    // Arguments of the call in progress; the task only captures this, so calling it does not allocate
+    const int32_t* actions;
+    uint8_t* observations;
+    float* rewards;
+    uint8_t* dones;
+    std::function<void(size_t, unsigned)> stepChunk;
+
+    size_t observationSize() const {
+        return encoders.empty() ? static_cast<size_t>(width) * height : encoders.front().getSize();
+    }
+    void startEpisode(EnvSlot& slot);
+    void writeObservation(const EnvSlot& slot, uint8_t* out) const;
+    void observe(size_t i, bool restarted);
+    void stepRange(size_t begin, size_t end);
+};
+
+
+void SnakeEnv::startEpisode(EnvSlot& slot) {
+    slot.sim.reset(slot.seedRng.next());
+    slot.over = false;
+}
+
+void SnakeEnv::writeObservation(const EnvSlot& slot, uint8_t* out) const {
+    const GameSim& sim = slot.sim;
+    const int left = sim.getLeftSpikeWall();
+    const int right = sim.getRightSpikeWall();
+    const int top = sim.getTopSpikeWall();
+    const int bottom = sim.getBottomSpikeWall();
+
+    // Spike rows above and below the walls, then per row the spike columns around the open part
+    std::memset(out, SNAKE_ENV_CELL_SPIKES, static_cast<size_t>(top) * width);
+    for (int y = top; y < bottom; ++y) {
+        uint8_t* row = out + static_cast<size_t>(y) * width;
+        std::memset(row, SNAKE_ENV_CELL_SPIKES, static_cast<size_t>(left));
+        std::memset(row + left, SNAKE_ENV_CELL_EMPTY, static_cast<size_t>(right - left));
+        std::memset(row + right, SNAKE_ENV_CELL_SPIKES, static_cast<size_t>(width - right));
+    }
+    std::memset(out + static_cast<size_t>(bottom) * width, SNAKE_ENV_CELL_SPIKES,
+                static_cast<size_t>(height - bottom) * width);
+
+    for (const Point& p : sim.getSnake()) out[static_cast<size_t>(p.y) * width + p.x] = SNAKE_ENV_CELL_BODY;
+    const Point head = sim.getSnake().front();
+    out[static_cast<size_t>(head.y) * width + head.x] = SNAKE_ENV_CELL_HEAD;
+    const Point food = sim.getFood();
+    if (food.x >= 0) out[static_cast<size_t>(food.y) * width + food.x] = SNAKE_ENV_CELL_FOOD;
+}
+
+void SnakeEnv::observe(size_t i, bool restarted) {
+    uint8_t* out = observations + i * observationSize();
+    if (encoders.empty()) writeObservation(slots[i], out);
+    else if (observations == lastObservations && !restarted) encoders[i].update(slots[i].sim, out);
+    else encoders[i].begin(slots[i].sim, out);
+}
+
+void SnakeEnv::stepRange(size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        EnvSlot& slot = slots[i];
+        float reward = 0.f;
+        bool done = slot.over;
+        bool restarted = false;
+        if (!slot.over) {
+            const int32_t action = actions[i];
+            const Direction direction = action >= SNAKE_ENV_ACTION_UP && action <= SNAKE_ENV_ACTION_RIGHT
+                                            ? static_cast<Direction>(action)
+                                            : Direction::NONE;
+            const StepResult result = slot.sim.step(direction);
+            if (result == StepResult::ATE) {
+                reward = 1.f;
+            } else if (result == StepResult::DIED) {
+                reward = -1.f;
+                done = true;
+                restarted = (flags & SNAKE_ENV_AUTO_RESET) != 0;
+                if (restarted) startEpisode(slot);
+                else slot.over = true;
+            }
+        }
+        if (rewards) rewards[i] = reward;
+        if (dones) dones[i] = done ? 1 : 0;
+        if (observations) observe(i, restarted);
+    }
+}
+
+
+uint32_t snake_env_abi_version(void) {
+    return SNAKE_ENV_ABI_VERSION;
+}
+
+SnakeEnv* snake_env_create(uint32_t count, int32_t width, int32_t height, uint64_t seed, uint32_t flags,
+                           uint32_t threads) {
+    if (count == 0 || !isValidBoardSize(width, height)) return nullptr;
+    if (flags & ~static_cast<uint32_t>(SNAKE_ENV_AUTO_RESET | SNAKE_ENV_NO_SPIKES)) return nullptr;
+
+    SnakeEnv* env = new (std::nothrow) SnakeEnv();
+    if (!env) return nullptr;
+    env->width = width;
+    env->height = height;
+    env->flags = flags;
+    env->lastObservations = nullptr;
+    try {
+        env->slots.reserve(count);
+        // Fold the high word in, so seeds that differ only above bit 31 give different games;
+        // seeds below 2^32 keep the games they always had
+        const uint32_t baseSeed = static_cast<uint32_t>(seed) ^ static_cast<uint32_t>(seed >> 32) * 0x9E3779B9u;
+        for (uint32_t i = 0; i < count; ++i) {
+            const uint32_t envSeed = deriveSeed(baseSeed, i);
+            env->slots.push_back({GameSim(envSeed, width, height), Rng(envSeed, RngStream::GAME_SEED), false});
+            env->slots.back().sim.setSpikesEnabled((flags & SNAKE_ENV_NO_SPIKES) == 0);
+        }
+        if (threads != 1 && count > ENV_CHUNK_SIZE) env->pool.reset(new WorkStealingPool(threads));
+    } catch (const std::bad_alloc&) {
+        delete env;
+        return nullptr;
+    }
+    env->stepChunk = [env](size_t chunk, unsigned) {
+        const size_t begin = chunk * ENV_CHUNK_SIZE;
+        env->stepRange(begin, std::min(begin + ENV_CHUNK_SIZE, env->slots.size()));
+    };
+    return env;
+}
+
+void snake_env_destroy(SnakeEnv* env) {
+    delete env;
+}
+
+uint32_t snake_env_count(const SnakeEnv* env) {
+    return static_cast<uint32_t>(env->slots.size());
+}
+
+uint32_t snake_env_observation_size(const SnakeEnv* env) {
+    return static_cast<uint32_t>(env->observationSize());
+}
+
+int32_t snake_env_set_observation(SnakeEnv* env, uint32_t format, int32_t crop_radius) {
+    if (crop_radius < 0 || crop_radius > MAX_GRID_SIDE) return -1;
+    if (format == SNAKE_ENV_OBS_CELLS) {
+        if (crop_radius != 0) return -1;
+        env->encoders.clear();
+        return 0;
+    }
+    if (format != SNAKE_ENV_OBS_CHANNELS && format != SNAKE_ENV_OBS_BIT_PLANES) return -1;
+
+    const ObservationEncoder encoder(env->width, env->height,
+                                     format == SNAKE_ENV_OBS_CHANNELS ? ObservationFormat::CHANNELS
+                                                                      : ObservationFormat::BIT_PLANES,
+                                     crop_radius);
+    try {
+        env->encoders.assign(env->slots.size(), encoder);
+    } catch (const std::bad_alloc&) {
+        env->encoders.clear();
+        return -1;
+    }
+    env->lastObservations = nullptr;
+    return 0;
+}
+
+void snake_env_reset(SnakeEnv* env, uint8_t* observations) {
+    env->observations = observations;
+    env->lastObservations = nullptr;
+    for (size_t i = 0; i < env->slots.size(); ++i) {
+        env->startEpisode(env->slots[i]);
+        if (observations) env->observe(i, true);
+    }
+    env->lastObservations = observations;
+}
+
+void snake_env_step(SnakeEnv* env, const int32_t* actions, uint8_t* observations, float* rewards, uint8_t* dones) {
+    env->actions = actions;
+    env->observations = observations;
+    env->rewards = rewards;
+    env->dones = dones;
+    if (env->pool) {
+        env->pool->parallelFor((env->slots.size() + ENV_CHUNK_SIZE - 1) / ENV_CHUNK_SIZE, env->stepChunk);
+    } else {
+        env->stepRange(0, env->slots.size());
+    }
+    env->lastObservations = observations;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+/* C ABI of libsnake_env: a batch of independent Snake games (GameSim, so the same rules as
+ * the game: spike walls and the speed-up on every food) stepped together for training code.
+ * Every call writes straight into caller-owned contiguous arrays indexed by environment;
+ * nothing is allocated after snake_env_create(). Only fixed-width types cross the boundary
+ * and the handle is opaque, so bindings (ctypes, cffi, ...) need nothing but this file. */
+
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(SNAKE_ENV_BUILD)
+#define SNAKE_ENV_API __declspec(dllexport)
+#else
+#define SNAKE_ENV_API __declspec(dllimport)
+#endif
+#else
+#define SNAKE_ENV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped whenever a signature or the observation layout changes. */
+#define SNAKE_ENV_ABI_VERSION 2 /* 2: snake_env_set_observation() */
+
+/* Observation formats, see snake_env_set_observation(). */
+enum {
+    SNAKE_ENV_OBS_CELLS = 0,     /* Default: one SNAKE_ENV_CELL_* byte per cell, row-major */
+    SNAKE_ENV_OBS_CHANNELS = 1,  /* Planes head, body, tail, food, blocked; one 0/1 byte per cell */
+    SNAKE_ENV_OBS_BIT_PLANES = 2 /* The same planes, one bit per cell (LSB first), each starting on a byte */
+};
+
+/* Cell values of SNAKE_ENV_OBS_CELLS. */
+enum {
+    SNAKE_ENV_CELL_EMPTY = 0,
+    SNAKE_ENV_CELL_BODY = 1,
+    SNAKE_ENV_CELL_HEAD = 2,
+    SNAKE_ENV_CELL_FOOD = 3,
+    SNAKE_ENV_CELL_SPIKES = 4 /* Covered by an advanced spike wall */
+};
+
+/* Actions, one int32 per environment. Any other value (and a reversal) keeps the direction. */
+enum {
+    SNAKE_ENV_ACTION_UP = 0,
+    SNAKE_ENV_ACTION_DOWN = 1,
+    SNAKE_ENV_ACTION_LEFT = 2,
+    SNAKE_ENV_ACTION_RIGHT = 3,
+    SNAKE_ENV_ACTION_NONE = 4
+};
+
+/* Flags for snake_env_create(). */
+enum {
+    SNAKE_ENV_AUTO_RESET = 1, /* A finished episode restarts within the same step() */
+    SNAKE_ENV_NO_SPIKES = 2   /* Walls never advance, episodes can fill the board */
+};
+
+typedef struct SnakeEnv SnakeEnv;
+
+SNAKE_ENV_API uint32_t snake_env_abi_version(void);
+
+/* count environments on a width x height board. Environment i plays seeds drawn from
+ * (seed, i), all 64 bits of seed included, so a batch replays identically for the same
+ * arguments and actions.
+ * threads == 0 uses every core, 1 steps on the calling thread.
+ * Returns NULL on invalid arguments. */
+SNAKE_ENV_API SnakeEnv* snake_env_create(uint32_t count, int32_t width, int32_t height, uint64_t seed,
+                                         uint32_t flags, uint32_t threads);
+SNAKE_ENV_API void snake_env_destroy(SnakeEnv* env);
+
+SNAKE_ENV_API uint32_t snake_env_count(const SnakeEnv* env);
+SNAKE_ENV_API uint32_t snake_env_observation_size(const SnakeEnv* env); /* Bytes per environment */
+
+/* Selects what observations hold from the next call on. crop_radius 0 shows the whole board,
+ * r > 0 a (2r + 1) x (2r + 1) window centred on the head (not for SNAKE_ENV_OBS_CELLS), with
+ * cells off the board marked blocked. The plane formats are updated in place, touching only
+ * cells that changed, as long as every step() gets the same observations pointer as the
+ * previous call; another pointer (or NULL in between) gets a full write.
+ * Returns 0, or -1 on invalid arguments. */
+SNAKE_ENV_API int32_t snake_env_set_observation(SnakeEnv* env, uint32_t format, int32_t crop_radius);
+
+/* Starts a new episode in every environment. observations (count * observation_size bytes)
+ * may be NULL. */
+SNAKE_ENV_API void snake_env_reset(SnakeEnv* env, uint8_t* observations);
+
+/* Moves every environment by one tick. actions holds count entries; rewards (+1 for food,
+ * -1 for dying, 0 otherwise) and dones (1 when the episode ended this step) receive count
+ * entries each. With SNAKE_ENV_AUTO_RESET the observation of a finished environment is
+ * the first one of its next episode; without it a finished environment stays over (reward
+ * 0, done 1) until snake_env_reset(). Any output pointer may be NULL. */
+SNAKE_ENV_API void snake_env_step(SnakeEnv* env, const int32_t* actions, uint8_t* observations, float* rewards,
+                                  uint8_t* dones);
+
+#ifdef __cplusplus
+}
+#endif
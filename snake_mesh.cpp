@@ -0,0 +1,137 @@
+#include "snake_mesh.h"
+
+#include <algorithm>
+#include <utility>
+
+
+namespace {
+
+const sf::Color HEAD_COLOR(0, 255, 0);
+const sf::Color BODY_COLOR(0, 200, 0);
+const sf::Color OUTLINE_COLOR(30, 30, 30);
+
+void writeQuad(sf::Vertex* quad, float left, float top, float size, const sf::Color& color) {
+    quad[0] = sf::Vertex(sf::Vector2f(left, top), color);
+    quad[1] = sf::Vertex(sf::Vector2f(left + size, top), color);
+    quad[2] = sf::Vertex(sf::Vector2f(left + size, top + size), color);
+    quad[3] = sf::Vertex(sf::Vector2f(left, top + size), color);
+}
+
+}
+
+
+SnakeMesh::SnakeMesh(float blockSize) : m_blockSize(blockSize), m_headFrom{0, 0}, m_tailFrom{0, 0}, m_tailTo{0, 0} {
+}
+
+void SnakeMesh::reset(const RingBuffer<Point>& snake) {
+    m_vertices.reserve((snake.size() + 1) * VERTICES_PER_SEGMENT);
+    m_vertices.assign(VERTICES_PER_SEGMENT, sf::Vertex()); // Ghost quad, placed by setInterpolation()
+    m_cellOfQuad.clear();
+    m_slotOfQuad.clear();
+    m_segmentQuads.clear();
+    if (m_segmentQuads.capacity() < snake.size()) growRing(snake.size());
+
+    // Push from the tail so the ring ends up in head-to-tail order
+    for (size_t i = snake.size(); i-- > 0;) {
+        pushHead(snake[i]);
+    }
+    if (!snake.empty()) m_headFrom = snake.front();
+    setInterpolation(1.f);
+}
+
+void SnakeMesh::pushHead(Point head) {
+    m_headFrom = head;
+    if (!m_segmentQuads.empty()) {
+        // The old head was last drawn part way along its move; body segments sit on their cells
+        const uint32_t front = m_segmentQuads.front();
+        m_headFrom = m_cellOfQuad[front];
+        writeSegment(quadVertices(front), static_cast<float>(m_headFrom.x), static_cast<float>(m_headFrom.y), BODY_COLOR);
+    }
+
+    if (m_segmentQuads.full()) growRing(m_segmentQuads.capacity() * 2);
+    uint32_t quad = static_cast<uint32_t>(m_segmentQuads.size());
+    m_vertices.resize(m_vertices.size() + VERTICES_PER_SEGMENT);
+    m_cellOfQuad.push_back(head);
+    writeSegment(quadVertices(quad), static_cast<float>(head.x), static_cast<float>(head.y), HEAD_COLOR);
+    m_segmentQuads.push_front(quad);
+    m_slotOfQuad.push_back(m_segmentQuads.slotOf(0));
+
+    // Tail stays put unless popTail() follows in the same tick
+    m_tailTo = m_cellOfQuad[m_segmentQuads.back()];
+    m_tailFrom = m_tailTo;
+}
+
+void SnakeMesh::popTail() {
+    uint32_t quad = m_segmentQuads.back();
+    m_tailFrom = m_cellOfQuad[quad];
+    m_segmentQuads.pop_back();
+
+    // Move the last quad into the freed one so the vertex list stays dense
+    uint32_t last = static_cast<uint32_t>(m_segmentQuads.size());
+    if (quad != last) {
+        std::copy(quadVertices(last), quadVertices(last) + VERTICES_PER_SEGMENT, quadVertices(quad));
+        m_cellOfQuad[quad] = m_cellOfQuad[last];
+        size_t slot = m_slotOfQuad[last];
+        m_segmentQuads.atSlot(slot) = quad;
+        m_slotOfQuad[quad] = slot;
+    }
+    m_vertices.resize(m_vertices.size() - VERTICES_PER_SEGMENT);
+    m_cellOfQuad.pop_back();
+    m_slotOfQuad.pop_back();
+    m_tailTo = m_segmentQuads.empty() ? m_tailFrom : m_cellOfQuad[m_segmentQuads.back()];
+}
+
+void SnakeMesh::setInterpolation(float alpha) {
+    if (m_segmentQuads.empty()) return;
+    alpha = std::min(std::max(alpha, 0.f), 1.f);
+
+    uint32_t head = m_segmentQuads.front();
+    Point headTo = m_cellOfQuad[head];
+    writeSegment(quadVertices(head), m_headFrom.x + (headTo.x - m_headFrom.x) * alpha,
+                 m_headFrom.y + (headTo.y - m_headFrom.y) * alpha, HEAD_COLOR);
+
+    // The ghost is drawn first, so when the tail did not move it simply hides under it
+    writeSegment(m_vertices.data(), m_tailFrom.x + (m_tailTo.x - m_tailFrom.x) * alpha,
+                 m_tailFrom.y + (m_tailTo.y - m_tailFrom.y) * alpha, m_segmentQuads.size() == 1 ? HEAD_COLOR : BODY_COLOR);
+}
+
+bool SnakeMesh::isBodyOnGrid() const {
+    sf::Vertex expected[VERTICES_PER_SEGMENT];
+    for (size_t i = 1; i < m_segmentQuads.size(); ++i) {
+        const uint32_t quad = m_segmentQuads[i];
+        const Point cell = m_cellOfQuad[quad];
+        writeSegment(expected, static_cast<float>(cell.x), static_cast<float>(cell.y), BODY_COLOR);
+        const sf::Vertex* vertices = &m_vertices[(quad + 1) * VERTICES_PER_SEGMENT];
+        for (size_t v = 0; v < VERTICES_PER_SEGMENT; ++v) {
+            if (vertices[v].position != expected[v].position || vertices[v].color != expected[v].color) return false;
+        }
+    }
+    return true;
+}
+
+void SnakeMesh::writeSegment(sf::Vertex* vertices, float x, float y, const sf::Color& fillColor) const {
+    // Same geometry as the old RectangleShape: 90% of the cell plus a 1px outline around it
+    float center = m_blockSize * 0.5f;
+    float fillSize = m_blockSize * 0.9f;
+    float left = x * m_blockSize + center - fillSize * 0.5f;
+    float top = y * m_blockSize + center - fillSize * 0.5f;
+
+    writeQuad(vertices, left - 1.f, top - 1.f, fillSize + 2.f, OUTLINE_COLOR);
+    writeQuad(vertices + 4, left, top, fillSize, fillColor);
+}
+
+void SnakeMesh::growRing(size_t capacity) {
+    RingBuffer<uint32_t> grown(capacity < MIN_RING_CAPACITY ? MIN_RING_CAPACITY : capacity);
+    for (size_t i = m_segmentQuads.size(); i-- > 0;) {
+        grown.push_front(m_segmentQuads[i]);
+    }
+    for (size_t i = 0; i < grown.size(); ++i) {
+        m_slotOfQuad[grown[i]] = grown.slotOf(i);
+    }
+    m_segmentQuads = std::move(grown);
+}
+
+void SnakeMesh::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    if (m_segmentQuads.empty()) return;
+    target.draw(m_vertices.data(), m_vertices.size(), sf::Quads, states);
+}
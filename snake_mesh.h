@@ -0,0 +1,57 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "game_sim.h"
+
+
+// Snake body as one quad list (outline + fill per segment) drawn with a single call.
+// Updated incrementally per tick: pushHead() appends a segment, popTail() swap-removes the
+// tail segment, so the cost of a tick does not depend on the snake length.
+// setInterpolation() slides the head from the previous head cell and a ghost segment from the
+// removed tail cell, so movement looks continuous between ticks; only two quads are touched.
+// The arrays grow with the snake rather than the board, so huge boards (drawn as a tilemap
+// most of the time) cost nothing here until the snake actually gets long.
+class SnakeMesh : public sf::Drawable {
+public:
+    explicit SnakeMesh(float blockSize);
+
+    // Takes effect on the next reset().
+    void setBlockSize(float blockSize) { m_blockSize = blockSize; }
+
+    // Rebuilds the mesh from scratch, e.g. after GameSim::reset().
+    void reset(const RingBuffer<Point>& snake);
+
+    void pushHead(Point head);
+    void popTail();
+
+    // Progress from the previous tick to the current one in [0, 1] (see FixedTimestep::getAlpha).
+    void setInterpolation(float alpha);
+
+    size_t getSegmentCount() const { return m_segmentQuads.size(); }
+
+    // Whether every segment but the head is drawn exactly on its cell, in the body colour.
+    bool isBodyOnGrid() const;
+
+private:
+    static const size_t VERTICES_PER_SEGMENT = 8;
+    static const size_t MIN_RING_CAPACITY = 64;
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+    sf::Vertex* quadVertices(uint32_t quad) { return &m_vertices[(quad + 1) * VERTICES_PER_SEGMENT]; }
+    void writeSegment(sf::Vertex* vertices, float x, float y, const sf::Color& fillColor) const;
+    void growRing(size_t capacity); // Keeps the segments, moves them to new slots
+
+    float m_blockSize;
+    std::vector<sf::Vertex> m_vertices;     // Ghost tail quad, then VERTICES_PER_SEGMENT per segment, unordered
+    std::vector<Point> m_cellOfQuad;        // Grid cell of each segment quad
+    RingBuffer<uint32_t> m_segmentQuads;    // Quad index of each segment, head to tail
+    std::vector<size_t> m_slotOfQuad;       // Quad index -> slot in m_segmentQuads
+
+    // Cells the head and the ghost tail move between during the current tick
+    Point m_headFrom;
+    Point m_tailFrom;
+    Point m_tailTo;
+};
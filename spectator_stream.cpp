@@ -0,0 +1,324 @@
+#include "spectator_stream.h"
+
+#include <algorithm>
+
+#include "byte_io.h"
+
+
+namespace {
+
+const uint8_t MAGIC[4] = {'S', 'N', 'K', 'S'};
+const size_t HEADER_SIZE = 9;
+
+const uint8_t TICK_HEAD_MOVED = 1 << 0;
+const int TICK_DIRECTION_SHIFT = 1;
+const uint8_t TICK_TAIL_REMOVED = 1 << 3;
+const uint8_t TICK_FOOD_MOVED = 1 << 4;
+const uint8_t TICK_WALLS_CHANGED = 1 << 5;
+const uint8_t TICK_SCORE_CHANGED = 1 << 6;
+
+const uint8_t KEYFRAME_NEW_GAME = 1 << 0;
+const uint8_t KEYFRAME_RESYNC = 1 << 1; // Written after records were dropped; readers may be out of step
+
+// Neighbour offsets in Direction order (UP, DOWN, LEFT, RIGHT)
+const int DIRECTION_DX[4] = {0, 0, -1, 1};
+const int DIRECTION_DY[4] = {-1, 1, 0, 0};
+
+uint8_t directionBetween(Point from, Point to) {
+    if (to.y < from.y) return static_cast<uint8_t>(Direction::UP);
+    if (to.y > from.y) return static_cast<uint8_t>(Direction::DOWN);
+    if (to.x < from.x) return static_cast<uint8_t>(Direction::LEFT);
+    return static_cast<uint8_t>(Direction::RIGHT);
+}
+
+Point step(Point p, uint8_t direction) {
+    return Point{p.x + DIRECTION_DX[direction], p.y + DIRECTION_DY[direction]};
+}
+
+uint64_t foodCode(Point food, int width) {
+    return food.x < 0 ? 0 : static_cast<uint64_t>(food.y) * width + food.x + 1;
+}
+
+void putWalls(ByteWriter& writer, const int* walls) {
+    for (int i = 0; i < 4; ++i) writer.putVarint(static_cast<uint64_t>(walls[i]));
+}
+
+void readWalls(const GameSim& sim, int* walls) {
+    walls[0] = sim.getLeftSpikeWall();
+    walls[1] = sim.getRightSpikeWall();
+    walls[2] = sim.getTopSpikeWall();
+    walls[3] = sim.getBottomSpikeWall();
+}
+
+}
+
+
+void SpectatorEncoder::writeHeader(const GameSim& sim, std::vector<uint8_t>& out) const {
+    ByteWriter writer(out);
+    writer.putBytes(MAGIC, sizeof(MAGIC));
+    writer.putU8(SPECTATOR_VERSION);
+    writer.putU16(static_cast<uint16_t>(sim.getWidth()));
+    writer.putU16(static_cast<uint16_t>(sim.getHeight()));
+}
+
+void SpectatorEncoder::begin(const GameSim& sim, std::vector<uint8_t>& out) {
+    m_tick = 0;
+    writeKeyframe(sim, KEYFRAME_NEW_GAME, out);
+}
+
+void SpectatorEncoder::record(const GameSim& sim, StepResult result, std::vector<uint8_t>& out) {
+    ++m_tick;
+    ByteWriter writer(out);
+    if (m_keyframeRequested) {
+        // Records were dropped, so a delta would be against a state readers never saw: a
+        // bare tick, then the keyframe
+        writer.putU8(static_cast<uint8_t>(SpectatorRecord::TICK));
+        writeKeyframe(sim, KEYFRAME_RESYNC, out);
+    } else {
+        writeDelta(sim, out);
+        if (m_keyframeInterval != 0 && m_tick % m_keyframeInterval == 0) writeKeyframe(sim, 0, out);
+    }
+
+    if (result == StepResult::DIED) {
+        writer.putU8(static_cast<uint8_t>(SpectatorRecord::GAME_OVER));
+        writer.putVarint(static_cast<uint64_t>(sim.getScore()));
+    }
+}
+
+void SpectatorEncoder::writeDelta(const GameSim& sim, std::vector<uint8_t>& out) {
+    const size_t flagsAt = out.size();
+    out.push_back(0);
+    ByteWriter writer(out);
+    uint8_t flags = static_cast<uint8_t>(SpectatorRecord::TICK);
+
+    const Point head = sim.getSnake().front();
+    if (!(head == m_head)) {
+        flags |= TICK_HEAD_MOVED | static_cast<uint8_t>(directionBetween(m_head, head) << TICK_DIRECTION_SHIFT);
+        if (sim.getSnake().size() == m_length) flags |= TICK_TAIL_REMOVED;
+    }
+    const Point food = sim.getFood();
+    if (!(food == m_food)) {
+        flags |= TICK_FOOD_MOVED;
+        writer.putVarint(foodCode(food, sim.getWidth()));
+    }
+    int walls[4];
+    readWalls(sim, walls);
+    if (!std::equal(walls, walls + 4, m_walls)) {
+        flags |= TICK_WALLS_CHANGED;
+        putWalls(writer, walls);
+    }
+    if (sim.getScore() != m_score) {
+        flags |= TICK_SCORE_CHANGED;
+        writer.putVarint(static_cast<uint64_t>(sim.getScore()));
+        writer.putVarint(static_cast<uint64_t>(sim.getTickMicros()));
+    }
+    out[flagsAt] = flags;
+    remember(sim);
+}
+
+void SpectatorEncoder::writeKeyframe(const GameSim& sim, uint8_t flags, std::vector<uint8_t>& out) {
+    const RingBuffer<Point>& snake = sim.getSnake();
+    m_payload.clear();
+    ByteWriter payload(m_payload);
+    payload.putVarint(m_tick);
+    payload.putU8(flags);
+    payload.putVarint(static_cast<uint64_t>(sim.getScore()));
+    payload.putVarint(static_cast<uint64_t>(sim.getTickMicros()));
+    payload.putU8(static_cast<uint8_t>(sim.getDirection()));
+    payload.putVarint(foodCode(sim.getFood(), sim.getWidth()));
+    int walls[4];
+    readWalls(sim, walls);
+    putWalls(payload, walls);
+    payload.putVarint(snake.size());
+    payload.putVarint(static_cast<uint64_t>(snake.front().y) * sim.getWidth() + snake.front().x);
+    uint8_t packed = 0;
+    for (size_t i = 1; i < snake.size(); ++i) {
+        packed |= static_cast<uint8_t>(directionBetween(snake[i - 1], snake[i]) << (2 * ((i - 1) % 4)));
+        if ((i - 1) % 4 == 3 || i + 1 == snake.size()) {
+            m_payload.push_back(packed);
+            packed = 0;
+        }
+    }
+
+    ByteWriter writer(out);
+    writer.putU8(static_cast<uint8_t>(SpectatorRecord::KEYFRAME));
+    writer.putVarint(m_payload.size());
+    writer.putBytes(m_payload.data(), m_payload.size());
+    m_keyframeRequested = false;
+    remember(sim);
+}
+
+void SpectatorEncoder::remember(const GameSim& sim) {
+    m_head = sim.getSnake().front();
+    m_length = sim.getSnake().size();
+    m_food = sim.getFood();
+    readWalls(sim, m_walls);
+    m_score = sim.getScore();
+}
+
+
+size_t SpectatorDecoder::feed(const uint8_t* data, size_t size, size_t maxRecords) {
+    if (m_failed) return 0;
+    size_t used = 0;
+    if (!m_hasHeader) {
+        if (size < HEADER_SIZE) return 0;
+        ByteReader reader(data, size);
+        uint8_t magic[4], version;
+        uint16_t width, height;
+        reader.getU8(magic[0]);
+        reader.getU8(magic[1]);
+        reader.getU8(magic[2]);
+        reader.getU8(magic[3]);
+        reader.getU8(version);
+        reader.getU16(width);
+        reader.getU16(height);
+        if (!std::equal(magic, magic + 4, MAGIC) || version != SPECTATOR_VERSION || !isValidBoardSize(width, height)) {
+            m_failed = true;
+            return 0;
+        }
+        m_state.width = width;
+        m_state.height = height;
+        m_hasHeader = true;
+        used = HEADER_SIZE;
+    }
+    size_t recordSize;
+    for (size_t records = 0; records < maxRecords && used < size && readRecord(data + used, size - used, recordSize); ++records) {
+        used += recordSize;
+    }
+    return m_failed ? 0 : used;
+}
+
+bool SpectatorDecoder::readRecord(const uint8_t* data, size_t size, size_t& used) {
+    ByteReader reader(data, size);
+    uint8_t type = 0;
+    if (!reader.getU8(type)) return false;
+
+    if (type & static_cast<uint8_t>(SpectatorRecord::TICK)) {
+        uint64_t food = 0, score = 0, tickMicros = 0, walls[4] = {0, 0, 0, 0};
+        if (type & TICK_FOOD_MOVED) reader.getVarint(food);
+        if (type & TICK_WALLS_CHANGED) {
+            for (uint64_t& wall : walls) reader.getVarint(wall);
+        }
+        if (type & TICK_SCORE_CHANGED) {
+            reader.getVarint(score);
+            reader.getVarint(tickMicros);
+        }
+        if (reader.hasFailed()) return false; // Incomplete, wait for more bytes
+        used = reader.getPosition();
+
+        const uint64_t cells = static_cast<uint64_t>(m_state.width) * m_state.height;
+        if (food > cells || ((type & TICK_WALLS_CHANGED) && !areWallsValid(walls))) {
+            m_failed = true;
+            return false;
+        }
+        m_ticks++;
+        m_state.tick++;
+        if (!m_synced) return true; // Nothing to apply the delta to until the next keyframe
+        if (type & TICK_HEAD_MOVED) {
+            const uint8_t direction = (type >> TICK_DIRECTION_SHIFT) & 3;
+            const Point head = step(m_state.snake.front(), direction);
+            const bool grows = !(type & TICK_TAIL_REMOVED);
+            if (!isOnBoard(head) || (grows && m_state.snake.size() >= cells)) {
+                m_failed = true;
+                return false;
+            }
+            m_state.direction = static_cast<Direction>(direction);
+            m_state.snake.push_front(head);
+            if (!grows) m_state.snake.pop_back();
+        }
+        if (type & TICK_FOOD_MOVED) {
+            m_state.food = food == 0 ? Point{-1, -1}
+                                     : Point{static_cast<int>((food - 1) % m_state.width),
+                                             static_cast<int>((food - 1) / m_state.width)};
+        }
+        if (type & TICK_WALLS_CHANGED) {
+            for (int i = 0; i < 4; ++i) m_state.walls[i] = static_cast<int>(walls[i]);
+        }
+        if (type & TICK_SCORE_CHANGED) {
+            m_state.score = static_cast<uint32_t>(score);
+            m_state.tickMicros = static_cast<uint32_t>(tickMicros);
+        }
+        return true;
+    }
+
+    if (type == static_cast<uint8_t>(SpectatorRecord::GAME_OVER)) {
+        uint64_t score;
+        if (!reader.getVarint(score)) return false;
+        used = reader.getPosition();
+        m_state.score = static_cast<uint32_t>(score);
+        m_state.gameOver = true;
+        return true;
+    }
+
+    if (type == static_cast<uint8_t>(SpectatorRecord::KEYFRAME)) {
+        uint64_t payloadSize;
+        if (!reader.getVarint(payloadSize) || reader.getRemaining() < payloadSize) return false;
+        used = reader.getPosition() + static_cast<size_t>(payloadSize);
+        if (!readKeyframe(data + reader.getPosition(), static_cast<size_t>(payloadSize))) m_failed = true;
+        return !m_failed;
+    }
+
+    m_failed = true;
+    return false;
+}
+
+bool SpectatorDecoder::readKeyframe(const uint8_t* data, size_t size) {
+    ByteReader reader(data, size);
+    uint64_t tick = 0, score = 0, tickMicros = 0, food = 0, walls[4] = {0, 0, 0, 0}, length = 0, head = 0;
+    uint8_t flags = 0, direction = 0;
+    reader.getVarint(tick);
+    reader.getU8(flags);
+    reader.getVarint(score);
+    reader.getVarint(tickMicros);
+    reader.getU8(direction);
+    reader.getVarint(food);
+    for (uint64_t& wall : walls) reader.getVarint(wall);
+    reader.getVarint(length);
+    reader.getVarint(head);
+    const uint64_t cells = static_cast<uint64_t>(m_state.width) * m_state.height;
+    if (reader.hasFailed() || direction > static_cast<uint8_t>(Direction::NONE) || length == 0 || length > cells ||
+        head >= cells || food > cells || !areWallsValid(walls) || reader.getRemaining() != (length - 1 + 3) / 4) {
+        return false;
+    }
+
+    SpectatorState next;
+    next.width = m_state.width;
+    next.height = m_state.height;
+    next.tick = static_cast<uint32_t>(tick);
+    next.score = static_cast<uint32_t>(score);
+    next.tickMicros = static_cast<uint32_t>(tickMicros);
+    next.direction = static_cast<Direction>(direction);
+    next.food = food == 0 ? Point{-1, -1}
+                          : Point{static_cast<int>((food - 1) % m_state.width), static_cast<int>((food - 1) / m_state.width)};
+    for (int i = 0; i < 4; ++i) next.walls[i] = static_cast<int>(walls[i]);
+    next.snake.push_back(Point{static_cast<int>(head % m_state.width), static_cast<int>(head / m_state.width)});
+    const uint8_t* packed = data + reader.getPosition();
+    for (uint64_t i = 1; i < length; ++i) {
+        const uint8_t segmentDirection = (packed[(i - 1) / 4] >> (2 * ((i - 1) % 4))) & 3;
+        next.snake.push_back(step(next.snake.back(), segmentDirection));
+        if (!isOnBoard(next.snake.back())) return false;
+    }
+
+    if (flags & KEYFRAME_NEW_GAME) {
+        m_games++;
+    } else if (!(flags & KEYFRAME_RESYNC) && m_synced && !m_state.gameOver) {
+        // Mid-game keyframe: everything the deltas rebuilt has to match it
+        const bool same = m_state.tick == next.tick && m_state.score == next.score &&
+                          m_state.tickMicros == next.tickMicros && m_state.food == next.food &&
+                          std::equal(next.walls, next.walls + 4, m_state.walls) && m_state.snake == next.snake;
+        if (!same) m_mismatches++;
+    }
+    m_state = std::move(next);
+    m_synced = true;
+    m_keyframes++;
+    return true;
+}
+
+bool SpectatorDecoder::isOnBoard(Point p) const {
+    return p.x >= 0 && p.x < m_state.width && p.y >= 0 && p.y < m_state.height;
+}
+
+bool SpectatorDecoder::areWallsValid(const uint64_t walls[4]) const {
+    return walls[0] < walls[1] && walls[1] <= static_cast<uint64_t>(m_state.width) && walls[2] < walls[3] &&
+           walls[3] <= static_cast<uint64_t>(m_state.height);
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "game_sim.h"
+
+
+// Live spectator stream of one GameSim session, for observers that do not run the game.
+//
+// Layout (little-endian, varints as in byte_io.h): "SNKS", u8 version, u16 width, u16 height,
+// then records, one tick record per step() followed by any keyframe or game over of that tick:
+//   0x80 | flags: one tick, where
+//       bit 0  head moved one cell, in the Direction of bits 1-2
+//       bit 3  tail cell removed
+//       bit 4  food moved: varint cell + 1 (0 = none left) follows
+//       bit 5  spike walls changed: varint left, right, top, bottom follow
+//       bit 6  score changed: varint score, varint tick micros follow
+//   0x01 keyframe, the state after the preceding tick record: varint payload size, then
+//        varint tick, u8 flags (bit 0: new game, bit 1: resync after dropped records),
+//        varint score, varint tick micros, u8 direction, varint food cell + 1, the four
+//        walls, varint length, varint head cell and 2 bits per segment (the Direction from
+//        each segment to the next one towards the tail, four to a byte, LSB first)
+//   0x02 game over: varint final score
+// After dropped records the tick record is a bare 0x80, followed by a resync keyframe.
+// Cells are y * width + x. A plain move costs one byte; a keyframe every
+// SPECTATOR_KEYFRAME_INTERVAL ticks (and at each game start) lets readers check and resync.
+const uint32_t SPECTATOR_KEYFRAME_INTERVAL = 600;
+const uint8_t SPECTATOR_VERSION = 1;
+
+enum class SpectatorRecord : uint8_t { KEYFRAME = 0x01, GAME_OVER = 0x02, TICK = 0x80 };
+
+
+// Appends records for a GameSim to a byte buffer. Call writeHeader() once per stream,
+// begin() after every reset() and record() after every step().
+class SpectatorEncoder {
+public:
+    explicit SpectatorEncoder(uint32_t keyframeInterval = SPECTATOR_KEYFRAME_INTERVAL)
+        : m_keyframeInterval(keyframeInterval) {}
+
+    void writeHeader(const GameSim& sim, std::vector<uint8_t>& out) const;
+    void begin(const GameSim& sim, std::vector<uint8_t>& out);
+    void record(const GameSim& sim, StepResult result, std::vector<uint8_t>& out);
+
+    // Adds a keyframe to the next record(), e.g. after bytes were lost on the way out.
+    void requestKeyframe() { m_keyframeRequested = true; }
+
+private:
+    void writeDelta(const GameSim& sim, std::vector<uint8_t>& out);
+    void writeKeyframe(const GameSim& sim, uint8_t flags, std::vector<uint8_t>& out);
+    void remember(const GameSim& sim);
+
+    uint32_t m_keyframeInterval;
+    bool m_keyframeRequested = false;
+    std::vector<uint8_t> m_payload; // Keyframe scratch, kept to avoid reallocating
+
+    // State the stream has described so far
+    uint32_t m_tick = 0;
+    Point m_head{-1, -1};
+    size_t m_length = 0;
+    Point m_food{-1, -1};
+    int m_walls[4] = {0, 0, 0, 0}; // Left, right, top, bottom
+    int m_score = 0;
+};
+
+
+// What a reader has rebuilt from a stream.
+struct SpectatorState {
+    int width = 0;
+    int height = 0;
+    uint32_t tick = 0;
+    uint32_t score = 0;
+    uint32_t tickMicros = 0;
+    Direction direction = Direction::NONE;
+    Point food{-1, -1};
+    int walls[4] = {0, 0, 0, 0};
+    std::deque<Point> snake; // Head first
+    bool gameOver = false;
+};
+
+
+// Incremental reader: feed() bytes as they arrive, in chunks of any size.
+class SpectatorDecoder {
+public:
+    // Applies the complete records in data, at most maxRecords of them, and returns the bytes
+    // used; the caller passes the rest again with more data. Returns 0 and sets hasFailed()
+    // on a malformed stream.
+    size_t feed(const uint8_t* data, size_t size, size_t maxRecords = SIZE_MAX);
+
+    bool hasHeader() const { return m_hasHeader; }
+    bool hasFailed() const { return m_failed; }
+    const SpectatorState& getState() const { return m_state; }
+
+    uint64_t getTickCount() const { return m_ticks; }
+    uint64_t getKeyframeCount() const { return m_keyframes; }
+    uint64_t getGameCount() const { return m_games; }
+    // Keyframes in the middle of a game that disagreed with the state rebuilt from deltas
+    uint64_t getMismatchCount() const { return m_mismatches; }
+
+private:
+    bool readRecord(const uint8_t* data, size_t size, size_t& used);
+    bool readKeyframe(const uint8_t* data, size_t size);
+    bool isOnBoard(Point p) const;
+    bool areWallsValid(const uint64_t walls[4]) const; // Ordered and within the board, like GameSim's
+
+    SpectatorState m_state;
+    bool m_hasHeader = false;
+    bool m_synced = false; // A keyframe was seen since the start or the last loss of sync
+    bool m_failed = false;
+    uint64_t m_ticks = 0;
+    uint64_t m_keyframes = 0;
+    uint64_t m_games = 0;
+    uint64_t m_mismatches = 0;
+};
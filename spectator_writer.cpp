@@ -0,0 +1,132 @@
+#include "spectator_writer.h"
+
+#include <cstdio>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+
+#if !defined(_WIN32)
+// Poll interval while a FIFO has no reader yet
+const std::chrono::milliseconds FIFO_RETRY_INTERVAL(100);
+#endif
+
+}
+
+
+SpectatorWriter::~SpectatorWriter() {
+    stop();
+}
+
+void SpectatorWriter::start(const std::string& path, const GameSim& sim) {
+    stop();
+#if !defined(_WIN32)
+    // A reader that goes away must fail the write, not kill the game with SIGPIPE
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+    m_path = path;
+    m_failed = false;
+    m_stopping = false;
+    m_droppedBytes = 0;
+    m_pending.clear();
+    m_scratch.clear();
+    m_encoder.writeHeader(sim, m_scratch);
+    queue();
+    m_thread = std::thread(&SpectatorWriter::run, this);
+}
+
+void SpectatorWriter::stop() {
+    if (!m_thread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void SpectatorWriter::begin(const GameSim& sim) {
+    if (!isRunning()) return;
+    m_encoder.begin(sim, m_scratch);
+    queue();
+}
+
+void SpectatorWriter::record(const GameSim& sim, StepResult result) {
+    if (!isRunning()) return;
+    m_encoder.record(sim, result, m_scratch);
+    queue();
+}
+
+void SpectatorWriter::queue() {
+    bool queued = false;
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_failed && m_pending.size() + m_scratch.size() <= MAX_PENDING_BYTES) {
+            wake = m_pending.empty(); // Otherwise the writer was woken already and has not taken the queue yet
+            m_pending.insert(m_pending.end(), m_scratch.begin(), m_scratch.end());
+            queued = true;
+        }
+    }
+    if (wake) {
+        m_wake.notify_one();
+    } else if (!queued) {
+        m_droppedBytes += m_scratch.size();
+        m_encoder.requestKeyframe();
+    }
+    m_scratch.clear();
+}
+
+void SpectatorWriter::run() {
+    FILE* out = nullptr;
+    if (m_path == "-") {
+        out = stdout;
+#if defined(_WIN32)
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    } else {
+#if defined(_WIN32)
+        out = std::fopen(m_path.c_str(), "wb");
+#else
+        // A blocking open of a FIFO waits for a reader with no way out; opening non-blocking
+        // fails with ENXIO until there is one, so retry until then or until stop()
+        int fd;
+        while ((fd = ::open(m_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_NONBLOCK, 0644)) < 0 && errno == ENXIO) {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_wake.wait_for(lock, FIFO_RETRY_INTERVAL, [this] { return m_stopping; })) break;
+        }
+        if (fd >= 0) {
+            ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) & ~O_NONBLOCK); // Writes may block, on this thread only
+            out = ::fdopen(fd, "wb");
+            if (!out) ::close(fd);
+        }
+#endif
+    }
+    if (!out) m_failed = true;
+
+    std::vector<uint8_t> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || !m_pending.empty(); });
+            if (m_pending.empty()) break; // Stopping with nothing left to write
+            batch.swap(m_pending);
+        }
+        // Flushed every batch so live readers see each tick as soon as it is written
+        if (!m_failed && (std::fwrite(batch.data(), 1, batch.size(), out) != batch.size() || std::fflush(out) != 0)) {
+            m_failed = true;
+        }
+        batch.clear();
+    }
+    if (out && out != stdout) std::fclose(out);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "game_sim.h"
+#include "spectator_stream.h"
+
+
+// Streams a game to spectators (see spectator_stream.h) from a background thread: the game
+// thread only encodes a few bytes per tick and appends them to a queue under a short lock;
+// opening, writing and flushing the file, FIFO or stdout all happen on the writer thread.
+// When the output falls more than MAX_PENDING_BYTES behind (a stalled reader), records are
+// dropped instead of blocking and the next tick is sent as a keyframe so readers resync.
+class SpectatorWriter {
+public:
+    SpectatorWriter() = default;
+    ~SpectatorWriter();
+
+    SpectatorWriter(const SpectatorWriter&) = delete;
+    SpectatorWriter& operator=(const SpectatorWriter&) = delete;
+
+    // Starts streaming sim's session to path ("-" for stdout). A FIFO without a reader does
+    // not hold up the caller: records queue until one opens it.
+    void start(const std::string& path, const GameSim& sim);
+    void stop(); // Writes out what is queued (dropped if a FIFO still has no reader), then joins the thread
+
+    // Call after every GameSim::reset() and step(); no-ops while not started.
+    void begin(const GameSim& sim);
+    void record(const GameSim& sim, StepResult result);
+
+    bool isRunning() const { return m_thread.joinable(); }
+    bool hasFailed() const { return m_failed; } // Output could not be opened or written; records are discarded
+    uint64_t getDroppedBytes() const { return m_droppedBytes; }
+
+private:
+    static const size_t MAX_PENDING_BYTES = 8 << 20;
+
+    void queue();
+    void run();
+
+    SpectatorEncoder m_encoder;
+    std::vector<uint8_t> m_scratch; // This tick's records, on the game thread
+    std::string m_path;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::vector<uint8_t> m_pending; // Guarded by m_mutex
+    bool m_stopping = false;        // Guarded by m_mutex
+    std::atomic<bool> m_failed{false};
+    uint64_t m_droppedBytes = 0;
+};
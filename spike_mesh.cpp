@@ -0,0 +1,51 @@
+#include "spike_mesh.h"
+
+
+SpikeMesh::SpikeMesh(float blockSize)
+    : m_blockSize(blockSize), m_vertices(sf::Quads), m_left(-1), m_right(-1), m_top(-1), m_bottom(-1) {
+}
+
+void SpikeMesh::setBlockSize(float blockSize) {
+    m_blockSize = blockSize;
+    m_left = m_right = m_top = m_bottom = -1; // Force a rebuild on the next update()
+}
+
+void SpikeMesh::update(const GameSim& sim) {
+    int left = sim.getLeftSpikeWall();
+    int right = sim.getRightSpikeWall();
+    int top = sim.getTopSpikeWall();
+    int bottom = sim.getBottomSpikeWall();
+    if (left == m_left && right == m_right && top == m_top && bottom == m_bottom) return;
+
+    m_left = left;
+    m_right = right;
+    m_top = top;
+    m_bottom = bottom;
+    m_vertices.clear();
+
+    for (int x = left; x < right; ++x) {
+        if (top > 0) appendSpike(x, top - 1);               // Draw top only if it has advanced
+        if (bottom < sim.getHeight()) appendSpike(x, bottom); // Draw bottom only if it has advanced
+    }
+    // Left and right walls (corners are already covered by the rows above)
+    for (int y = top; y < bottom; ++y) {
+        if (left > 0) appendSpike(left - 1, y);
+        if (right < sim.getWidth()) appendSpike(right, y);
+    }
+}
+
+void SpikeMesh::appendSpike(int x, int y) {
+    const sf::Color spikeColor = sf::Color::Yellow;
+    float size = m_blockSize * 0.8f;
+    float left = x * m_blockSize + (m_blockSize - size) * 0.5f;
+    float top = y * m_blockSize + (m_blockSize - size) * 0.5f;
+    m_vertices.append(sf::Vertex(sf::Vector2f(left, top), spikeColor));
+    m_vertices.append(sf::Vertex(sf::Vector2f(left + size, top), spikeColor));
+    m_vertices.append(sf::Vertex(sf::Vector2f(left + size, top + size), spikeColor));
+    m_vertices.append(sf::Vertex(sf::Vector2f(left, top + size), spikeColor));
+}
+
+void SpikeMesh::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    if (m_vertices.getVertexCount() == 0) return;
+    target.draw(m_vertices, states);
+}
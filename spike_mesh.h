@@ -0,0 +1,30 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include "game_sim.h"
+
+
+// Spike border as a cached quad list. The walls only move every SPIKE_ADVANCE_INTERVAL
+// (or snap back when food is eaten), so the geometry is rebuilt only when update() sees
+// different wall positions and is drawn with one call otherwise.
+class SpikeMesh : public sf::Drawable {
+public:
+    explicit SpikeMesh(float blockSize);
+
+    void setBlockSize(float blockSize);
+
+    // Rebuilds the quads if the walls in sim moved since the last call.
+    void update(const GameSim& sim);
+
+private:
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+    void appendSpike(int x, int y);
+
+    float m_blockSize;
+    sf::VertexArray m_vertices;
+    int m_left;
+    int m_right;
+    int m_top;
+    int m_bottom;
+};
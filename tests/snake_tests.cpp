@@ -0,0 +1,285 @@
+// Headless determinism and equivalence checks, registered with ctest (one test per check).
+//   snake_tests [check]...
+// Without arguments every check runs. Exits 1 when any check fails.
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "autopilot.h"
+#include "lockstep_sim.h"
+#include "observation_encoder.h"
+#include "replay.h"
+#include "spectator_stream.h"
+#if defined(SNAKE_TESTS_RENDER)
+#include "snake_mesh.h"
+#endif
+
+
+namespace {
+
+int failures = 0;
+
+void expect(bool condition, const char* check, const std::string& what) {
+    if (condition) return;
+    std::fprintf(stderr, "%s: %s\n", check, what.c_str());
+    failures++;
+}
+
+// Mostly the autopilot, with random turns (reversals included) mixed in, so games both last
+// and end in every way
+Direction pickMove(const GameSim& sim, Autopilot& autopilot, Rng& rng) {
+    if (rng.nextBelow(32) == 0) return static_cast<Direction>(rng.nextBelow(5));
+    return autopilot.decide(sim);
+}
+
+// Games recorded, encoded, decoded and played back into a GameSim that ran something else
+// before: every tick has to reproduce the recorded state hash.
+void checkReplay() {
+    const int sizes[][2] = {{DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT}, {7, 5}, {64, 48}};
+    for (const auto& size : sizes) {
+        for (unsigned seed = 1; seed <= 20; ++seed) {
+            const std::string game = std::to_string(size[0]) + "x" + std::to_string(size[1]) + " seed " + std::to_string(seed);
+            GameSim sim(seed, size[0], size[1]);
+            sim.setSpikesEnabled(seed % 2 == 0);
+            sim.reset(seed);
+            Autopilot autopilot;
+            Rng rng(seed, RngStream::POLICY);
+            ReplayRecorder recorder;
+            recorder.begin(sim);
+            std::vector<uint64_t> hashes;
+            for (int tick = 0; tick < 5000 && sim.isAlive(); ++tick) {
+                sim.step(pickMove(sim, autopilot, rng));
+                recorder.record(sim);
+                hashes.push_back(sim.computeStateHash());
+            }
+            const std::vector<uint8_t> bytes = recorder.finish(sim).encode();
+
+            Replay replay;
+            expect(replay.decode(bytes.data(), bytes.size()), "replay", game + ": decode failed");
+            expect(replay.encode() == bytes, "replay", game + ": encode(decode()) differs");
+
+            GameSim played(seed + 1000, size[0], size[1]);
+            for (int i = 0; i < 100; ++i) played.step(static_cast<Direction>(i / 7 % 4));
+            ReplayPlayer player(&replay);
+            player.start(played);
+            size_t tick = 0;
+            while (!player.isFinished() && tick < hashes.size()) {
+                player.step(played);
+                if (played.computeStateHash() != hashes[tick]) break;
+                ++tick;
+            }
+            expect(tick == hashes.size() && player.isFinished(), "replay",
+                   game + ": diverged at tick " + std::to_string(tick));
+            expect(played.computeStateHash() == replay.finalStateHash &&
+                   static_cast<uint32_t>(played.getScore()) == replay.finalScore,
+                   "replay", game + ": final state differs");
+        }
+    }
+
+    // Events have to be in strictly increasing ticks, all before tickCount
+    Replay bad;
+    bad.tickCount = 10;
+    bad.events = {{2, Direction::UP}, {2, Direction::LEFT}};
+    std::vector<uint8_t> bytes = bad.encode();
+    expect(!Replay().decode(bytes.data(), bytes.size()), "replay", "two events on one tick decoded");
+    bad.events = {{2, Direction::UP}, {10, Direction::LEFT}};
+    bytes = bad.encode();
+    expect(!Replay().decode(bytes.data(), bytes.size()), "replay", "event at tickCount decoded");
+}
+
+// LockstepSim against one GameSim per game, with the kernel picked for this CPU and with the
+// scalar lanes: same results and the same state after every step, deaths and resets included.
+// 37 games leave a partly used lane group.
+void checkLockstep() {
+    const int sizes[][2] = {{DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT}, {9, 6}};
+    for (const auto& size : sizes) {
+        for (bool forceScalar : {false, true}) {
+            const size_t games = 37;
+            LockstepSim lockstep(games, forceScalar, size[0], size[1]);
+            const std::string name = std::string(lockstep.getBackendName()) + " " + std::to_string(size[0]) + "x" +
+                                     std::to_string(size[1]);
+            std::vector<GameSim> sims;
+            for (size_t i = 0; i < games; ++i) sims.emplace_back(static_cast<unsigned>(i), size[0], size[1]);
+            std::vector<Direction> requested(games);
+            std::vector<StepResult> results(games);
+            Rng rng(7, RngStream::POLICY);
+
+            bool same = true;
+            for (uint32_t tick = 0; tick < 3000 && same; ++tick) {
+                for (Direction& direction : requested) direction = static_cast<Direction>(rng.nextBelow(5));
+                lockstep.step(requested.data(), results.data());
+                for (size_t i = 0; i < games && same; ++i) {
+                    GameSim& sim = sims[i];
+                    same = sim.step(requested[i]) == results[i] && sim.isAlive() == lockstep.isAlive(i) &&
+                           sim.getScore() == lockstep.getScore(i) && sim.getDirection() == lockstep.getDirection(i) &&
+                           sim.getTickMicros() == lockstep.getTickMicros(i) && sim.getFood() == lockstep.getFood(i) &&
+                           sim.getLeftSpikeWall() == lockstep.getLeftSpikeWall(i) &&
+                           sim.getRightSpikeWall() == lockstep.getRightSpikeWall(i) &&
+                           sim.getTopSpikeWall() == lockstep.getTopSpikeWall(i) &&
+                           sim.getBottomSpikeWall() == lockstep.getBottomSpikeWall(i) &&
+                           sim.getSnake().size() == lockstep.getLength(i);
+                    for (size_t s = 0; s < sim.getSnake().size() && same; ++s) {
+                        same = sim.getSnake()[s] == lockstep.getSegment(i, s);
+                    }
+                    expect(same, "lockstep", name + ": game " + std::to_string(i) + " differs at tick " + std::to_string(tick));
+                    if (results[i] == StepResult::DIED) {
+                        const unsigned seed = static_cast<unsigned>(tick + i);
+                        sim.reset(seed);
+                        lockstep.resetGame(i, seed);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// ObservationEncoder::update() after every step against a fresh begin(), for both formats,
+// whole-board and cropped views and with the spike walls closing in.
+void checkObservation() {
+    const int sizes[][2] = {{DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT}, {13, 9}};
+    for (const auto& size : sizes) {
+        for (ObservationFormat format : {ObservationFormat::CHANNELS, ObservationFormat::BIT_PLANES}) {
+            for (int cropRadius : {0, 4}) {
+                const std::string name = std::string(format == ObservationFormat::CHANNELS ? "channels " : "bit planes ") +
+                                         std::to_string(size[0]) + "x" + std::to_string(size[1]) + " crop " +
+                                         std::to_string(cropRadius);
+                ObservationEncoder encoder(size[0], size[1], format, cropRadius);
+                std::vector<uint8_t> updated(encoder.getSize());
+                std::vector<uint8_t> fresh(encoder.getSize());
+                GameSim sim(11, size[0], size[1]);
+                Autopilot autopilot;
+                Rng rng(11, RngStream::POLICY);
+                encoder.begin(sim, updated.data());
+
+                bool same = true;
+                for (uint32_t tick = 0; tick < 5000 && same; ++tick) {
+                    if (sim.step(pickMove(sim, autopilot, rng)) == StepResult::DIED) {
+                        sim.reset(tick);
+                        autopilot.reset();
+                    }
+                    encoder.update(sim, updated.data());
+                    encoder.begin(sim, fresh.data());
+                    same = updated == fresh;
+                    expect(same, "observation", name + ": update() differs from begin() at tick " + std::to_string(tick));
+                }
+            }
+        }
+    }
+}
+
+// A spectator stream that loses windows of records the way SpectatorWriter drops them when
+// its reader stalls (whole ticks, then requestKeyframe()): the decoder has to keep going and
+// match the game again after every record it receives.
+void checkSpectator() {
+    for (unsigned seed = 1; seed <= 50; ++seed) {
+        const std::string game = "seed " + std::to_string(seed);
+        GameSim sim(seed, 12, 10);
+        sim.setSpikesEnabled(seed % 2 == 0);
+        Autopilot autopilot;
+        Rng rng(seed, RngStream::POLICY);
+        SpectatorEncoder encoder(100);
+        SpectatorDecoder decoder;
+        std::vector<uint8_t> bytes;
+        std::vector<uint8_t> records;
+        encoder.writeHeader(sim, bytes);
+        encoder.begin(sim, bytes);
+
+        uint32_t dropUntil = 0;
+        bool same = true;
+        for (uint32_t tick = 1; tick <= 20000 && same; ++tick) {
+            records.clear();
+            const StepResult result = sim.step(pickMove(sim, autopilot, rng));
+            encoder.record(sim, result, records);
+            if (result == StepResult::DIED) {
+                sim.reset(seed + tick);
+                autopilot.reset();
+                encoder.begin(sim, records);
+            }
+            if (dropUntil == 0 && rng.nextBelow(200) == 0) dropUntil = tick + 1 + rng.nextBelow(30);
+            if (tick < dropUntil) {
+                encoder.requestKeyframe();
+                continue;
+            }
+            dropUntil = 0;
+
+            bytes.insert(bytes.end(), records.begin(), records.end());
+            const size_t used = decoder.feed(bytes.data(), bytes.size());
+            bytes.erase(bytes.begin(), bytes.begin() + used);
+            const SpectatorState& state = decoder.getState();
+            same = !decoder.hasFailed() && bytes.empty() && decoder.getMismatchCount() == 0 &&
+                   state.score == static_cast<uint32_t>(sim.getScore()) && state.food == sim.getFood() &&
+                   state.walls[0] == sim.getLeftSpikeWall() && state.walls[1] == sim.getRightSpikeWall() &&
+                   state.walls[2] == sim.getTopSpikeWall() && state.walls[3] == sim.getBottomSpikeWall() &&
+                   state.snake.size() == sim.getSnake().size();
+            for (size_t s = 0; s < state.snake.size() && same; ++s) same = state.snake[s] == sim.getSnake()[s];
+            expect(same, "spectator", game + ": decoder differs from the game at tick " + std::to_string(tick));
+        }
+    }
+}
+
+#if defined(SNAKE_TESTS_RENDER)
+// SnakeMesh as the game drives it, interpolating between ticks: after every push and pop all
+// segments but the head have to sit exactly on their cells, wherever the head was drawn.
+void checkMesh() {
+    GameSim sim(5, 16, 12);
+    sim.setSpikesEnabled(false);
+    Autopilot autopilot;
+    Rng rng(5, RngStream::POLICY);
+    SnakeMesh mesh(20.f);
+    mesh.reset(sim.getSnake());
+
+    bool onGrid = true;
+    for (uint32_t tick = 0; tick < 5000 && onGrid; ++tick) {
+        mesh.setInterpolation(rng.nextFloat()); // A frame drawn part way through the move
+        const StepResult result = sim.step(pickMove(sim, autopilot, rng));
+        if (result == StepResult::DIED) {
+            sim.reset(tick);
+            autopilot.reset();
+            mesh.reset(sim.getSnake());
+        } else if (result != StepResult::IDLE) {
+            mesh.pushHead(sim.getSnake().front());
+            if (result == StepResult::MOVED) mesh.popTail();
+        }
+        onGrid = mesh.isBodyOnGrid() && mesh.getSegmentCount() == sim.getSnake().size();
+        expect(onGrid, "mesh", "body off its cells after tick " + std::to_string(tick));
+    }
+}
+#endif
+
+struct Check {
+    const char* name;
+    void (*run)();
+};
+
+const Check CHECKS[] = {
+    {"replay", checkReplay},
+    {"lockstep", checkLockstep},
+    {"observation", checkObservation},
+    {"spectator", checkSpectator},
+#if defined(SNAKE_TESTS_RENDER)
+    {"mesh", checkMesh},
+#endif
+};
+
+}
+
+
+int main(int argc, char** argv) {
+    for (const Check& check : CHECKS) {
+        bool selected = argc == 1;
+        for (int i = 1; i < argc; ++i) selected = selected || std::strcmp(argv[i], check.name) == 0;
+        if (selected) check.run();
+    }
+    for (int i = 1; i < argc; ++i) {
+        bool known = false;
+        for (const Check& check : CHECKS) known = known || std::strcmp(argv[i], check.name) == 0;
+        if (!known) {
+            std::fprintf(stderr, "unknown check %s\n", argv[i]);
+            failures++;
+        }
+    }
+    if (failures) std::fprintf(stderr, "%d failure(s)\n", failures);
+    return failures ? 1 : 0;
+}
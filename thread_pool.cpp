@@ -0,0 +1,88 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount)
+    : m_task(nullptr), m_remaining(0), m_generation(0), m_stop(false) {
+    if (threadCount == 0) threadCount = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < threadCount; ++i) {
+        m_queues.emplace_back(new WorkerQueue());
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        m_threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& thread : m_threads) thread.join();
+}
+
+void WorkStealingPool::parallelFor(size_t count, const std::function<void(size_t, unsigned)>& task) {
+    if (count == 0) return;
+
+    // Publish the task before any index becomes visible to a worker
+    m_task = &task;
+    m_remaining.store(count);
+    const size_t queueCount = m_queues.size();
+    for (size_t q = 0; q < queueCount; ++q) {
+        std::lock_guard<std::mutex> lock(m_queues[q]->mutex);
+        for (size_t i = q; i < count; i += queueCount) {
+            m_queues[q]->tasks.push_back(i);
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    ++m_generation;
+    m_wake.notify_all();
+    m_done.wait(lock, [this] { return m_remaining.load() == 0; });
+}
+
+bool WorkStealingPool::popOrSteal(unsigned worker, size_t& task) {
+    {
+        WorkerQueue& own = *m_queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    const size_t queueCount = m_queues.size();
+    for (size_t offset = 1; offset < queueCount; ++offset) {
+        WorkerQueue& victim = *m_queues[(worker + offset) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(unsigned worker) {
+    uint64_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation != seenGeneration; });
+            if (m_stop) return;
+            seenGeneration = m_generation;
+        }
+
+        size_t task;
+        while (popOrSteal(worker, task)) {
+            (*m_task)(task, worker);
+            if (m_remaining.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_done.notify_all();
+            }
+        }
+    }
+}
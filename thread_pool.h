@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+// Fixed set of worker threads with one task queue each. parallelFor() deals the task
+// indices round-robin into the queues; a worker pops from the back of its own queue and,
+// once that is empty, steals from the front of the others, so uneven tasks balance out.
+class WorkStealingPool {
+public:
+    // threadCount == 0 uses std::thread::hardware_concurrency().
+    explicit WorkStealingPool(unsigned threadCount = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Runs task(i) for every i in [0, count) and blocks until all of them finished.
+    // task(i) receives the index of the worker running it as the second argument.
+    void parallelFor(size_t count, const std::function<void(size_t, unsigned)>& task);
+
+    unsigned getThreadCount() const { return static_cast<unsigned>(m_threads.size()); }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    void workerLoop(unsigned worker);
+    bool popOrSteal(unsigned worker, size_t& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    const std::function<void(size_t, unsigned)>* m_task;
+    std::atomic<size_t> m_remaining;
+    uint64_t m_generation;
+    bool m_stop;
+};
@@ -0,0 +1,129 @@
+// Headless batch simulator: steps many independent games across all cores and reports
+// aggregate throughput. --snapshot writes every game's final state to a save state file,
+// --resume continues the games of such a file (its board and game count) instead of new ones.
+//   snake_batch [--games N] [--ticks T] [--threads K] [--seed S] [--width W] [--height H]
+//               [--policy random|autopilot|hamiltonian] [--snapshot file.snkt] [--resume file.snkt]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "batch_runner.h"
+#include "save_state.h"
+
+
+namespace {
+
+void printUsage() {
+    std::fprintf(stderr, "usage: snake_batch [--games N] [--ticks T] [--threads K] [--seed S] [--width W] [--height H]\n"
+                         "                   [--policy random|autopilot|hamiltonian] [--snapshot file.snkt] [--resume file.snkt]\n");
+}
+
+}
+
+
+int main(int argc, char** argv) {
+    size_t games = 4096;
+    unsigned long long ticks = 10000;
+    unsigned threads = 0;
+    unsigned long seed = 1;
+    int width = DEFAULT_GRID_WIDTH;
+    int height = DEFAULT_GRID_HEIGHT;
+    std::string policy = "random";
+    std::string snapshotPath;
+    std::string resumePath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+        if (arg == "--games") games = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--ticks") ticks = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--threads") threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--seed") seed = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--width") width = std::atoi(argv[++i]);
+        else if (arg == "--height") height = std::atoi(argv[++i]);
+        else if (arg == "--policy") policy = argv[++i];
+        else if (arg == "--snapshot") snapshotPath = argv[++i];
+        else if (arg == "--resume") resumePath = argv[++i];
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    SaveStateFile resumeFile;
+    if (!resumePath.empty()) {
+        if (!resumeFile.open(resumePath)) {
+            std::fprintf(stderr, "cannot open save states %s\n", resumePath.c_str());
+            return 1;
+        }
+        games = resumeFile.getSlotCount();
+        width = resumeFile.getWidth();
+        height = resumeFile.getHeight();
+    }
+
+    if (!isValidBoardSize(width, height)) {
+        std::fprintf(stderr, "board size must be between 1x1 and %dx%d\n", MAX_GRID_SIDE, MAX_GRID_SIDE);
+        return 1;
+    }
+
+    BatchPolicy batchPolicy;
+    if (policy == "random") batchPolicy = BatchPolicy::RANDOM;
+    else if (policy == "autopilot") batchPolicy = BatchPolicy::AUTOPILOT;
+    else if (policy == "hamiltonian") batchPolicy = BatchPolicy::HAMILTONIAN;
+    else {
+        printUsage();
+        return 1;
+    }
+
+    BatchRunner runner(games, static_cast<uint32_t>(seed), threads, width, height, batchPolicy);
+    if (resumeFile.isOpen()) {
+        for (size_t i = 0; i < games; ++i) {
+            if (!resumeFile.load(i, runner.getGame(i))) {
+                std::fprintf(stderr, "save state %zu in %s is invalid\n", i, resumePath.c_str());
+                return 1;
+            }
+        }
+        resumeFile.close();
+    }
+    BatchStats stats = runner.run(ticks);
+
+    double snapshotSeconds = 0.0;
+    size_t snapshotBytes = 0;
+    if (!snapshotPath.empty()) {
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<size_t> slotSizes(games);
+        for (size_t i = 0; i < games; ++i) slotSizes[i] = getSaveStateSize(runner.getGame(i));
+        SaveStateFile snapshot;
+        if (!snapshot.create(snapshotPath, width, height, slotSizes)) {
+            std::fprintf(stderr, "cannot create %s\n", snapshotPath.c_str());
+            return 1;
+        }
+        for (size_t i = 0; i < games; ++i) {
+            snapshot.save(i, runner.getGame(i));
+            snapshotBytes += slotSizes[i];
+        }
+        snapshot.close();
+        snapshotSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::printf("games:          %zu\n", runner.getGameCount());
+    std::printf("board:          %dx%d\n", width, height);
+    std::printf("policy:         %s\n", policy.c_str());
+    std::printf("threads:        %u\n", runner.getThreadCount());
+    std::printf("ticks:          %llu\n", static_cast<unsigned long long>(stats.ticks));
+    std::printf("finished games: %llu\n", static_cast<unsigned long long>(stats.gamesFinished));
+    std::printf("mean score:     %.3f\n", stats.gamesFinished ? double(stats.totalScore) / stats.gamesFinished : 0.0);
+    std::printf("seconds:        %.3f\n", stats.seconds);
+    std::printf("ticks/second:   %.0f\n", stats.ticksPerSecond());
+    if (!snapshotPath.empty()) {
+        std::printf("snapshot:       %s (%zu bytes)\n", snapshotPath.c_str(), snapshotBytes);
+        std::printf("snapshot secs:  %.3f\n", snapshotSeconds);
+    }
+    return 0;
+}
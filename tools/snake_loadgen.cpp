@@ -0,0 +1,203 @@
+// Client load generator for snake_server: N clients on localhost, each with its own UDP
+// socket, decoding every snapshot, steering by its view and acknowledging what it decoded.
+// Reports what the clients received and whether every delta rebuilt the server's view.
+//   snake_loadgen [--port P] [--clients N] [--seconds S] [--loss fraction] [--seed S]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "byte_io.h"
+#include "net_protocol.h"
+#include "rng.h"
+#include "udp_socket.h"
+
+
+namespace {
+
+const double CONNECT_RETRY_SECONDS = 0.5;
+
+const int DIRECTION_DX[4] = {0, 0, -1, 1};
+const int DIRECTION_DY[4] = {-1, 1, 0, 0};
+
+struct LoadClient {
+    UdpSocket socket;
+    std::unique_ptr<SnapshotDecoder> decoder; // Created from the WELCOME's view radius
+    bool rejected = false;
+    double lastConnectAt = -1.0;
+    Rng rng;
+    Direction direction = Direction::NONE;
+    uint64_t bytesIn = 0;
+    uint64_t snapshots = 0;
+    uint64_t dropped = 0;  // Thrown away to simulate loss
+    uint64_t skipped = 0;  // Snapshot ticks never seen (lost, or dropped here)
+    uint32_t lastTick = NET_NO_TICK;
+    uint32_t tickMicros = 0; // Server tick period from the WELCOME
+};
+
+void printUsage() {
+    std::fprintf(stderr, "usage: snake_loadgen [--port P] [--clients N] [--seconds S] [--loss fraction] [--seed S]\n");
+}
+
+// Safe-first move from the client's own view: food next to the head, else mostly straight on
+Direction steer(LoadClient& client) {
+    const SnapshotView& view = client.decoder->getLatest();
+    const int side = client.decoder->getViewSide();
+    const int centre = side / 2;
+    const uint32_t roll = client.rng.next();
+    Direction best = client.direction;
+    int bestScore = -1;
+    for (int d = 0; d < 4; ++d) {
+        const Direction direction = static_cast<Direction>(d);
+        if (isOppositeDirection(direction, client.direction)) continue;
+        const uint8_t cell = view.cells[static_cast<size_t>(centre + DIRECTION_DY[d]) * side + centre + DIRECTION_DX[d]];
+        int score = 0;
+        if (cell == static_cast<uint8_t>(ViewCell::FOOD)) score = 3;
+        else if (cell == static_cast<uint8_t>(ViewCell::EMPTY)) score = 1;
+        if (score > 0 && direction == client.direction && (roll >> 8) % 8 != 0) score++;
+        score = score * 4 + static_cast<int>((roll >> (2 * d)) & 3); // Random tie-break
+        if (score > bestScore) {
+            bestScore = score;
+            best = direction;
+        }
+    }
+    return best;
+}
+
+void sendPacket(LoadClient& client, const std::vector<uint8_t>& packet, uint16_t port) {
+    client.socket.send(packet.data(), packet.size(), UdpAddress::loopback(port));
+}
+
+}
+
+
+int main(int argc, char** argv) {
+    uint16_t port = 7777;
+    size_t clientCount = 64;
+    double seconds = 10.0;
+    double loss = 0.0;
+    uint32_t seed = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+        if (arg == "--port") port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        else if (arg == "--clients") clientCount = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--seconds") seconds = std::atof(argv[++i]);
+        else if (arg == "--loss") loss = std::min(1.0, std::max(0.0, std::atof(argv[++i])));
+        else if (arg == "--seed") seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::vector<LoadClient> clients(clientCount);
+    for (size_t i = 0; i < clientCount; ++i) {
+        if (!clients[i].socket.open(0)) {
+            std::fprintf(stderr, "cannot open UDP socket %zu\n", i);
+            return 1;
+        }
+        clients[i].rng.seed(deriveSeed(seed, static_cast<uint32_t>(i)), RngStream::POLICY);
+    }
+
+    std::vector<uint8_t> packet;
+    std::vector<uint8_t> buffer(NET_MAX_PACKET_SIZE);
+    const uint32_t dropThreshold = static_cast<uint32_t>(loss * 4294967295.0);
+    const auto start = std::chrono::steady_clock::now();
+    double elapsed = 0.0;
+    while (elapsed < seconds) {
+        for (LoadClient& client : clients) {
+            if (!client.decoder && !client.rejected && elapsed - client.lastConnectAt >= CONNECT_RETRY_SECONDS) {
+                packet.clear();
+                writeNetHeader(packet, NetMessage::CONNECT);
+                packet.push_back(NET_PROTOCOL_VERSION);
+                sendPacket(client, packet, port);
+                client.lastConnectAt = elapsed;
+            }
+
+            UdpAddress from;
+            int size;
+            while ((size = client.socket.receive(buffer.data(), buffer.size(), from)) > 0) {
+                NetMessage message;
+                if (from.port != port || !readNetHeader(buffer.data(), static_cast<size_t>(size), message)) continue;
+                client.bytesIn += static_cast<uint64_t>(size);
+                if (message == NetMessage::WELCOME && !client.decoder) {
+                    ByteReader reader(buffer.data() + 3, static_cast<size_t>(size) - 3);
+                    uint32_t slot, tickMicros;
+                    uint16_t width, height;
+                    uint8_t radius;
+                    if (reader.getU32(slot) && reader.getU16(width) && reader.getU16(height) && reader.getU8(radius) &&
+                        reader.getU32(tickMicros)) {
+                        client.decoder.reset(new SnapshotDecoder(radius));
+                        client.tickMicros = tickMicros;
+                    }
+                } else if (message == NetMessage::REJECT) {
+                    client.rejected = true;
+                } else if (message == NetMessage::SNAPSHOT && client.decoder) {
+                    if (client.rng.next() < dropThreshold) {
+                        client.dropped++;
+                        continue;
+                    }
+                    if (client.decoder->apply(buffer.data(), static_cast<size_t>(size))) {
+                        const uint32_t tick = client.decoder->getAckTick();
+                        if (client.lastTick != NET_NO_TICK && tick > client.lastTick + 1) client.skipped += tick - client.lastTick - 1;
+                        client.lastTick = tick;
+                        client.snapshots++;
+                        client.direction = steer(client);
+                    }
+                    packet.clear();
+                    writeNetHeader(packet, NetMessage::INPUT);
+                    ByteWriter writer(packet);
+                    writer.putU32(client.decoder->getAckTick());
+                    writer.putU8(static_cast<uint8_t>(client.direction));
+                    sendPacket(client, packet, port);
+                }
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    packet.clear();
+    writeNetHeader(packet, NetMessage::DISCONNECT);
+    size_t connected = 0, rejected = 0;
+    uint32_t tickMicros = 0;
+    uint64_t bytesIn = 0, snapshots = 0, dropped = 0, skipped = 0, keyframes = 0, missingBaselines = 0, checksumFailures = 0;
+    for (LoadClient& client : clients) {
+        if (client.decoder) {
+            sendPacket(client, packet, port);
+            connected++;
+            tickMicros = client.tickMicros;
+            keyframes += client.decoder->getKeyframeCount();
+            missingBaselines += client.decoder->getMissingBaselineCount();
+            checksumFailures += client.decoder->getChecksumFailureCount();
+        }
+        if (client.rejected) rejected++;
+        bytesIn += client.bytesIn;
+        snapshots += client.snapshots;
+        dropped += client.dropped;
+        skipped += client.skipped;
+    }
+
+    const double clientSeconds = connected * elapsed;
+    std::printf("clients:           %zu connected, %zu rejected\n", connected, rejected);
+    std::printf("seconds:           %.2f\n", elapsed);
+    std::printf("snapshots/s:       %.2f per client of %.2f sent\n", clientSeconds > 0 ? snapshots / clientSeconds : 0.0,
+                tickMicros ? 1000000.0 / tickMicros : 0.0);
+    std::printf("received:          %.2f KB/s per client, %.1f bytes per snapshot\n",
+                clientSeconds > 0 ? bytesIn / clientSeconds / 1024.0 : 0.0, snapshots ? double(bytesIn) / snapshots : 0.0);
+    std::printf("keyframes:         %llu\n", static_cast<unsigned long long>(keyframes));
+    std::printf("dropped (--loss):  %llu\n", static_cast<unsigned long long>(dropped));
+    std::printf("ticks not seen:    %llu\n", static_cast<unsigned long long>(skipped));
+    std::printf("missing baselines: %llu\n", static_cast<unsigned long long>(missingBaselines));
+    std::printf("checksum failures: %llu\n", static_cast<unsigned long long>(checksumFailures));
+    return checksumFailures == 0 ? 0 : 1;
+}
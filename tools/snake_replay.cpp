@@ -0,0 +1,59 @@
+// Headless replay playback: re-simulates a recorded game as fast as possible and checks that
+// it ends in the recorded state. --spectate also streams the playback (see spectator_stream.h)
+// to a file, FIFO or stdout ("-").
+//   snake_replay <file.snkr> [--repeat N] [--spectate path]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "replay.h"
+#include "spectator_writer.h"
+
+
+int main(int argc, char** argv) {
+    int repeat = 1;
+    std::string spectatePath;
+    bool validArgs = argc >= 2 && argc % 2 == 0;
+    for (int i = 2; validArgs && i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--repeat") repeat = std::max(1, std::atoi(argv[i + 1]));
+        else if (arg == "--spectate") spectatePath = argv[i + 1];
+        else validArgs = false;
+    }
+    if (!validArgs) {
+        std::fprintf(stderr, "usage: snake_replay <file.snkr> [--repeat N] [--spectate path]\n");
+        return 1;
+    }
+
+    Replay replay;
+    if (!replay.loadFromFile(argv[1])) {
+        std::fprintf(stderr, "Error loading replay %s\n", argv[1]);
+        return 1;
+    }
+    GameSim sim(0, replay.width, replay.height);
+    ReplayPlayer player(&replay);
+    SpectatorWriter spectator;
+    if (!spectatePath.empty()) spectator.start(spectatePath, sim);
+    auto start = std::chrono::steady_clock::now();
+    for (int run = 0; run < repeat; ++run) {
+        player.start(sim);
+        spectator.begin(sim);
+        while (!player.isFinished()) spectator.record(sim, player.step(sim));
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    spectator.stop();
+    if (spectator.hasFailed()) std::fprintf(stderr, "Error writing spectator stream to %s\n", spectatePath.c_str());
+    FILE* report = spectatePath == "-" ? stderr : stdout; // Keep a stream on stdout clean
+
+    uint64_t hash = sim.computeStateHash();
+    bool identical = hash == replay.finalStateHash && static_cast<uint32_t>(sim.getScore()) == replay.finalScore;
+    std::fprintf(report, "ticks:        %u (%zu direction changes)\n", replay.tickCount, replay.events.size());
+    std::fprintf(report, "score:        %d (recorded %u)\n", sim.getScore(), replay.finalScore);
+    std::fprintf(report, "state hash:   %016llx (recorded %016llx)\n", static_cast<unsigned long long>(hash),
+                static_cast<unsigned long long>(replay.finalStateHash));
+    std::fprintf(report, "result:       %s\n", identical ? "identical" : "MISMATCH");
+    if (seconds > 0.0) std::fprintf(report, "ticks/second: %.0f\n", double(replay.tickCount) * repeat / seconds);
+    return identical ? 0 : 2;
+}
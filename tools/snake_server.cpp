@@ -0,0 +1,138 @@
+// Authoritative arena server: runs an ArenaSim at a fixed tick rate, takes inputs from UDP
+// clients (see net_protocol.h) and reports tick time and bandwidth per client.
+//   snake_server [--port P] [--width W] [--height H] [--slots N] [--food F] [--radius R]
+//                [--hz T] [--seconds S] [--report S] [--seed S] [--no-bots] [--any]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "arena_server.h"
+
+
+namespace {
+
+void printUsage() {
+    std::fprintf(stderr, "usage: snake_server [--port P] [--width W] [--height H] [--slots N] [--food F] [--radius R]\n"
+                         "                    [--hz T] [--seconds S] [--report S] [--seed S] [--no-bots] [--any]\n");
+}
+
+uint32_t percentile(std::vector<uint32_t>& values, double fraction) {
+    if (values.empty()) return 0;
+    const size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+void printStats(double elapsed, ArenaServerStats& stats, size_t clients, double hz, uint64_t overruns) {
+    const double clientSeconds = static_cast<double>(stats.clientTicks) / hz;
+    const uint32_t maxMicros = stats.tickMicros.empty() ? 0 : *std::max_element(stats.tickMicros.begin(), stats.tickMicros.end());
+    std::printf("%7.1fs clients %4zu | tick us p50 %5u p99 %5u max %5u late %llu | per client out %6.2f KB/s in %5.2f KB/s"
+                " | keyframes %5.2f%%\n",
+                elapsed, clients, percentile(stats.tickMicros, 0.5), percentile(stats.tickMicros, 0.99), maxMicros,
+                static_cast<unsigned long long>(overruns),
+                clientSeconds > 0 ? stats.bytesOut / clientSeconds / 1024.0 : 0.0,
+                clientSeconds > 0 ? stats.bytesIn / clientSeconds / 1024.0 : 0.0,
+                stats.clientTicks ? 100.0 * stats.keyframes / stats.clientTicks : 0.0);
+    std::fflush(stdout);
+}
+
+}
+
+
+int main(int argc, char** argv) {
+    ArenaServerConfig config;
+    double hz = 1000000.0 / ARENA_TICK_MICROS;
+    double seconds = 0.0; // 0 = until killed
+    double reportSeconds = 5.0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--no-bots") {
+            config.bots = false;
+            continue;
+        }
+        if (arg == "--any") {
+            config.loopbackOnly = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            printUsage();
+            return 1;
+        }
+        if (arg == "--port") config.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        else if (arg == "--width") config.width = std::atoi(argv[++i]);
+        else if (arg == "--height") config.height = std::atoi(argv[++i]);
+        else if (arg == "--slots") config.slots = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--food") config.food = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--radius") config.viewRadius = std::atoi(argv[++i]);
+        else if (arg == "--hz") hz = std::atof(argv[++i]);
+        else if (arg == "--seconds") seconds = std::atof(argv[++i]);
+        else if (arg == "--report") reportSeconds = std::atof(argv[++i]);
+        else if (arg == "--seed") config.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (!isValidBoardSize(config.width, config.height) || config.width > 65535 || config.height > 65535) {
+        std::fprintf(stderr, "board size must be between 1x1 and %dx%d\n", MAX_GRID_SIDE, MAX_GRID_SIDE);
+        return 1;
+    }
+    if (config.slots == 0 || (config.slots + config.food) * 2 > static_cast<size_t>(config.width) * config.height) {
+        std::fprintf(stderr, "slots and food must cover at most half of the board\n");
+        return 1;
+    }
+    if (config.viewRadius < 0 || config.viewRadius > NET_MAX_VIEW_RADIUS || !(hz > 0.0) || reportSeconds <= 0.0) {
+        printUsage();
+        return 1;
+    }
+
+    // The arena's spike timers and the clients count in whole microseconds of this period
+    config.tickMicros = static_cast<int32_t>(std::min(std::max(std::round(1000000.0 / hz), 1.0), 1e9));
+    hz = 1000000.0 / config.tickMicros;
+
+    ArenaServer server(config);
+    if (!server.open()) {
+        std::fprintf(stderr, "cannot bind UDP port %u\n", static_cast<unsigned>(config.port));
+        return 1;
+    }
+    std::printf("serving a %dx%d arena with %zu slots on %s:%u at %.1f Hz\n", config.width, config.height, config.slots,
+                config.loopbackOnly ? "127.0.0.1" : "0.0.0.0", static_cast<unsigned>(server.getPort()), hz);
+    std::fflush(stdout);
+
+    // Ticks are scheduled on a fixed grid; a tick that overruns its slot starts the next one
+    // at once, and a backlog of more than one tick is dropped instead of replayed in a burst
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration period = std::chrono::duration_cast<Clock::duration>(std::chrono::microseconds(config.tickMicros));
+    const Clock::time_point start = Clock::now();
+    Clock::time_point nextTick = start;
+    Clock::time_point nextReport = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(reportSeconds));
+    uint64_t overruns = 0;
+    for (;;) {
+        server.tick();
+
+        const Clock::time_point now = Clock::now();
+        const double elapsed = std::chrono::duration<double>(now - start).count();
+        if (now >= nextReport) {
+            ArenaServerStats stats = server.takeStats();
+            printStats(elapsed, stats, server.getClientCount(), hz, overruns);
+            overruns = 0;
+            nextReport += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(reportSeconds));
+        }
+        if (seconds > 0.0 && elapsed >= seconds) break;
+
+        nextTick += period;
+        if (now > nextTick) {
+            overruns++;
+            if (now - nextTick > period) nextTick = now;
+        }
+        std::this_thread::sleep_until(nextTick);
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Spectator stream reader: follows a stream written by the game (--spectate) or snake_replay
+// from a file, FIFO or stdin, checks every keyframe against the state rebuilt from the deltas
+// and prints a line per game, or per tick with --ticks.
+//   snake_spectate [file|-] [--ticks]
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "spectator_stream.h"
+
+
+namespace {
+
+void printTick(const SpectatorState& state) {
+    const Point head = state.snake.empty() ? Point{-1, -1} : state.snake.front();
+    std::printf("tick %6u score %4u length %5zu head %4d,%-4d food %4d,%-4d walls %d %d %d %d%s\n", state.tick,
+                state.score, state.snake.size(), head.x, head.y, state.food.x, state.food.y, state.walls[0],
+                state.walls[1], state.walls[2], state.walls[3], state.gameOver ? " game over" : "");
+}
+
+}
+
+
+int main(int argc, char** argv) {
+    std::string path = "-";
+    bool perTick = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--ticks") == 0) perTick = true;
+        else if (argv[i][0] != '-' || std::strcmp(argv[i], "-") == 0) path = argv[i];
+        else {
+            std::fprintf(stderr, "usage: snake_spectate [file|-] [--ticks]\n");
+            return 1;
+        }
+    }
+    FILE* in = path == "-" ? stdin : std::fopen(path.c_str(), "rb");
+    if (!in) {
+        std::fprintf(stderr, "cannot read %s\n", path.c_str());
+        return 1;
+    }
+
+    SpectatorDecoder decoder;
+    std::vector<uint8_t> buffer;
+    uint8_t chunk[1 << 16];
+    uint64_t bytes = 0;
+    bool gameOverSeen = false;
+    size_t got;
+    while ((got = std::fread(chunk, 1, sizeof(chunk), in)) > 0) {
+        bytes += got;
+        buffer.insert(buffer.end(), chunk, chunk + got);
+        // One record per feed() so every tick and game end can be reported as it happens
+        size_t used = 0;
+        size_t step;
+        while ((step = decoder.feed(buffer.data() + used, buffer.size() - used, 1)) > 0) {
+            used += step;
+            const SpectatorState& state = decoder.getState();
+            if (perTick && !state.snake.empty()) printTick(state);
+            if (state.gameOver && !gameOverSeen) {
+                std::printf("game %llu over: score %u after %u ticks\n",
+                            static_cast<unsigned long long>(decoder.getGameCount()), state.score, state.tick);
+            }
+            gameOverSeen = state.gameOver;
+        }
+        buffer.erase(buffer.begin(), buffer.begin() + used);
+        if (decoder.hasFailed()) break;
+    }
+    if (in != stdin) std::fclose(in);
+
+    std::printf("bytes:      %llu (%.2f per tick)\n", static_cast<unsigned long long>(bytes),
+                decoder.getTickCount() ? double(bytes) / decoder.getTickCount() : 0.0);
+    std::printf("games:      %llu\n", static_cast<unsigned long long>(decoder.getGameCount()));
+    std::printf("ticks:      %llu\n", static_cast<unsigned long long>(decoder.getTickCount()));
+    std::printf("keyframes:  %llu\n", static_cast<unsigned long long>(decoder.getKeyframeCount()));
+    std::printf("mismatches: %llu\n", static_cast<unsigned long long>(decoder.getMismatchCount()));
+    if (decoder.hasFailed() || !decoder.hasHeader()) {
+        std::printf("result:     malformed stream\n");
+        return 2;
+    }
+    if (!buffer.empty()) std::printf("result:     %zu bytes of a cut-off record at the end\n", buffer.size());
+    return decoder.getMismatchCount() == 0 ? 0 : 2;
+}
@@ -0,0 +1,160 @@
+#include "udp_socket.h"
+
+#include <cstring>
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+
+namespace {
+
+#if defined(_WIN32)
+typedef int SocketLength;
+
+bool startNetworking() {
+    static const bool started = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    return started;
+}
+
+void closeHandle(intptr_t handle) {
+    closesocket(static_cast<SOCKET>(handle));
+}
+
+bool wouldBlock() {
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+#else
+typedef socklen_t SocketLength;
+
+bool startNetworking() {
+    return true;
+}
+
+void closeHandle(intptr_t handle) {
+    ::close(static_cast<int>(handle));
+}
+
+bool wouldBlock() {
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+#endif
+
+sockaddr_in toSockaddr(const UdpAddress& address) {
+    sockaddr_in result;
+    std::memset(&result, 0, sizeof(result));
+    result.sin_family = AF_INET;
+    result.sin_addr.s_addr = htonl(address.ip);
+    result.sin_port = htons(address.port);
+    return result;
+}
+
+}
+
+
+UdpSocket::UdpSocket() : m_handle(-1), m_port(0) {
+}
+
+UdpSocket::~UdpSocket() {
+    close();
+}
+
+UdpSocket::UdpSocket(UdpSocket&& other) : m_handle(other.m_handle), m_port(other.m_port) {
+    other.m_handle = -1;
+    other.m_port = 0;
+}
+
+UdpSocket& UdpSocket::operator=(UdpSocket&& other) {
+    if (this != &other) {
+        close();
+        m_handle = other.m_handle;
+        m_port = other.m_port;
+        other.m_handle = -1;
+        other.m_port = 0;
+    }
+    return *this;
+}
+
+bool UdpSocket::open(uint16_t port, bool loopbackOnly) {
+    close();
+    if (!startNetworking()) return false;
+    const auto handle = ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+#if defined(_WIN32)
+    if (handle == INVALID_SOCKET) return false;
+#else
+    if (handle < 0) return false;
+#endif
+    m_handle = static_cast<intptr_t>(handle);
+
+    sockaddr_in address = toSockaddr(UdpAddress{loopbackOnly ? 0x7F000001u : 0u, port});
+    if (::bind(handle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        close();
+        return false;
+    }
+#if defined(_WIN32)
+    u_long nonBlocking = 1;
+    const bool configured = ioctlsocket(handle, FIONBIO, &nonBlocking) == 0;
+#else
+    const bool configured = fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+    SocketLength length = sizeof(address);
+    if (!configured || ::getsockname(handle, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        close();
+        return false;
+    }
+    m_port = ntohs(address.sin_port);
+    return true;
+}
+
+void UdpSocket::close() {
+    if (m_handle != -1) closeHandle(m_handle);
+    m_handle = -1;
+    m_port = 0;
+}
+
+bool UdpSocket::isOpen() const {
+    return m_handle != -1;
+}
+
+bool UdpSocket::setBufferSizes(int bytes) {
+    if (m_handle == -1) return false;
+    const char* value = reinterpret_cast<const char*>(&bytes);
+    return ::setsockopt(m_handle, SOL_SOCKET, SO_RCVBUF, value, sizeof(bytes)) == 0 &&
+           ::setsockopt(m_handle, SOL_SOCKET, SO_SNDBUF, value, sizeof(bytes)) == 0;
+}
+
+int UdpSocket::receive(uint8_t* buffer, size_t capacity, UdpAddress& from) {
+    if (m_handle == -1) return -1;
+    sockaddr_in address;
+    SocketLength length = sizeof(address);
+    const auto received = ::recvfrom(m_handle, reinterpret_cast<char*>(buffer), static_cast<int>(capacity), 0,
+                                     reinterpret_cast<sockaddr*>(&address), &length);
+    if (received < 0) {
+#if defined(_WIN32)
+        if (WSAGetLastError() == WSAEMSGSIZE) return static_cast<int>(capacity); // Truncated, like recvfrom elsewhere
+        if (WSAGetLastError() == WSAECONNRESET) return 0; // ICMP port unreachable from an earlier send
+#endif
+        return wouldBlock() ? 0 : -1;
+    }
+    from.ip = ntohl(address.sin_addr.s_addr);
+    from.port = ntohs(address.sin_port);
+    return static_cast<int>(received);
+}
+
+bool UdpSocket::send(const uint8_t* data, size_t size, const UdpAddress& to) {
+    if (m_handle == -1) return false;
+    const sockaddr_in address = toSockaddr(to);
+    return ::sendto(m_handle, reinterpret_cast<const char*>(data), static_cast<int>(size), 0,
+                    reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == static_cast<int>(size);
+}
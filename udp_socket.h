@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+// IPv4 address and port in host byte order.
+struct UdpAddress {
+    uint32_t ip;
+    uint16_t port;
+
+    static UdpAddress loopback(uint16_t port) { return UdpAddress{0x7F000001u, port}; }
+
+    uint64_t getKey() const { return (static_cast<uint64_t>(ip) << 16) | port; } // Unique per address, for maps
+    bool operator==(const UdpAddress& other) const { return ip == other.ip && port == other.port; }
+};
+
+
+// Non-blocking IPv4 UDP socket. receive() returns at once when nothing is queued, so a
+// fixed-rate loop can drain the socket every tick without a thread of its own.
+class UdpSocket {
+public:
+    UdpSocket();
+    ~UdpSocket();
+
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+    UdpSocket(UdpSocket&& other);
+    UdpSocket& operator=(UdpSocket&& other);
+
+    // Binds to port (0 picks a free one) on the loopback interface, or on every interface
+    // when loopbackOnly is false. False if the socket cannot be created or bound.
+    bool open(uint16_t port, bool loopbackOnly = true);
+    void close();
+    bool isOpen() const;
+
+    // Requests kernel send and receive buffers of bytes each; false if the OS refused.
+    bool setBufferSizes(int bytes);
+
+    uint16_t getPort() const { return m_port; } // The bound port, also when open() picked it
+
+    // Size of the next datagram (truncated to capacity), 0 when none is queued, -1 on error.
+    int receive(uint8_t* buffer, size_t capacity, UdpAddress& from);
+    bool send(const uint8_t* data, size_t size, const UdpAddress& to);
+
+private:
+    intptr_t m_handle; // SOCKET on Windows, a file descriptor elsewhere; -1 when closed
+    uint16_t m_port;
+};